@@ -80,9 +80,9 @@ namespace GDMENUCardManager.Core
 
                 // Read and validate magic header
                 byte[] magic = reader.ReadBytes(4);
-                if (magic[0] != 'D' || magic[1] != 'A' || magic[2] != 'T' || magic[3] != 0x01)
+                if (magic[0] != 'D' || magic[1] != 'A' || magic[2] != 'T' || (magic[3] != 0x01 && magic[3] != 0x02))
                 {
-                    LoadError = "Invalid magic header (expected DAT\\x01)";
+                    LoadError = "Invalid magic header (expected DAT\\x01 or DAT\\x02)";
                     return;
                 }
 
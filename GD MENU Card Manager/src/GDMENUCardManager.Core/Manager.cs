@@ -426,8 +426,8 @@ namespace GDMENUCardManager.Core
 
                 // Check magic
                 byte[] magic = reader.ReadBytes(4);
-                if (magic[0] != 'D' || magic[1] != 'A' || magic[2] != 'T' || magic[3] != 0x01)
-                    return (false, "Invalid magic header (expected DAT\\x01)");
+                if (magic[0] != 'D' || magic[1] != 'A' || magic[2] != 'T' || (magic[3] != 0x01 && magic[3] != 0x02))
+                    return (false, "Invalid magic header (expected DAT\\x01 or DAT\\x02)");
 
                 // Check entry size
                 uint entrySize = reader.ReadUInt32();
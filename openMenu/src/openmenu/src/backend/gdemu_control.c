@@ -9,6 +9,7 @@
 #include "backend/controls.p1.h"
 #include "backend/gdemu_sdk.h"
 #include "backend/gdmenu_binary.h"
+#include "texture/txr_manager.h"
 #include "vm2/vm2_api.h"
 #include "../dcnow/dcnow_net_init.h"
 
@@ -57,6 +58,7 @@ void
 bloom_launch(gd_item* disc) {
     /* Disconnect modem/PPP before launching PSX game to ensure clean state */
     dcnow_net_disconnect();
+    txr_stop_prefetch();
 
     file_t fd;
     uint32_t bloom_size;
@@ -91,6 +93,7 @@ void
 bleem_launch(gd_item* disc) {
     /* Disconnect modem/PPP before launching PSX game to ensure clean state */
     dcnow_net_disconnect();
+    txr_stop_prefetch();
 
     file_t fd;
     uint32_t bleem_size;
@@ -134,6 +137,7 @@ void
 dreamcast_launch_disc(gd_item* disc) {
     /* Disconnect modem/PPP before launching game to ensure clean state */
     dcnow_net_disconnect();
+    txr_stop_prefetch();
 
     /* For non-game discs (audio CDs, etc.), just mount and exit to BIOS */
     if (!strcmp(disc->type, "other")) {
@@ -221,6 +225,7 @@ void
 dreamcast_launch_cb(gd_item* disc) {
     /* Disconnect modem/PPP before launching CodeBreaker to ensure clean state */
     dcnow_net_disconnect();
+    txr_stop_prefetch();
 
     file_t fd;
     uint32_t cb_size;
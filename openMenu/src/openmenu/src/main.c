@@ -146,10 +146,10 @@ init() {
     /* Load settings */
     savefile_init();
 
-    ret += txr_create_small_pool();
-    ret += txr_create_large_pool();
+    ret += txr_create_pool();
     ret += txr_load_DATs();
     ret += list_read_default();
+    ret += txr_resolve_list();
     check_bloom_available();  /* Check for BLOOM.BIN once at startup */
     ret += db_load_DAT();
     ret += theme_manager_load();
@@ -489,6 +489,8 @@ void
 exit_to_bios_ex(int do_mount, int do_send_id) {
     /* Disconnect modem/PPP before exiting to ensure clean state */
     dcnow_net_disconnect();
+    /* Cover reads must be done before the image is swapped */
+    txr_stop_prefetch();
 
     bloader_cfg_t* bloader_config = (bloader_cfg_t*)&bloader_data[bloader_size - sizeof(bloader_cfg_t)];
 
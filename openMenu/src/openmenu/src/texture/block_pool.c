@@ -15,27 +15,32 @@
 
 #include "block_pool.h"
 
+static inline unsigned int
+_pool_words(unsigned int slots) {
+    return (slots + POOL_WORD_BITS - 1) / POOL_WORD_BITS;
+}
+
 static inline void
 _pool_mark_used(block_pool* pool, unsigned int slot_num) {
-    pool->state[slot_num] = 1;
+    pool->free[slot_num / POOL_WORD_BITS] &= ~(1u << (slot_num % POOL_WORD_BITS));
 }
 
 static inline void
 _pool_mark_open(block_pool* pool, unsigned int slot_num) {
-    pool->state[slot_num] = 0;
+    pool->free[slot_num / POOL_WORD_BITS] |= (1u << (slot_num % POOL_WORD_BITS));
 }
 
 void
 pool_create(block_pool* pool, void* buffer, unsigned int size, unsigned int slots) {
-    const unsigned int state_size = sizeof(unsigned char) * slots;
+    const unsigned int free_size = sizeof(uint32_t) * _pool_words(slots);
     const unsigned int format_size = sizeof(slot_format) * slots;
 
     pool->base = buffer;
     pool->size = size;
     pool->slots = slots;
-    pool->slot_size = size / slots;
-    pool->state = malloc(state_size);
-    if (!pool->state) {
+    pool->slot_size = slots ? size / slots : 0;
+    pool->free = malloc(free_size);
+    if (!pool->free) {
         printf("%s no free memory\n", __func__);
         return;
     }
@@ -44,14 +49,17 @@ pool_create(block_pool* pool, void* buffer, unsigned int size, unsigned int slot
         printf("%s no free memory\n", __func__);
         return;
     }
-    memset(pool->state, '\0', state_size);
     memset(pool->format, '\0', format_size);
+    pool_dealloc_all(pool);
 }
 
+/* Lowest free slot, a word of slots at a time */
 void
 pool_get_next_free(block_pool* pool, unsigned int* slot_num, void** ptr) {
-    for (unsigned int i = 0; i < pool->slots; i++) {
-        if (!pool->state[i]) {
+    const unsigned int words = _pool_words(pool->slots);
+    for (unsigned int w = 0; w < words; w++) {
+        if (pool->free[w]) {
+            const unsigned int i = (w * POOL_WORD_BITS) + (unsigned int)(__builtin_ffs((int)pool->free[w]) - 1);
             _pool_mark_used(pool, i);
 
             if (slot_num) {
@@ -72,8 +80,13 @@ pool_get_next_free(block_pool* pool, unsigned int* slot_num, void** ptr) {
 
 void
 pool_dealloc_all(block_pool* pool) {
-    for (unsigned int i = 0; i < pool->slots; i++) {
-        _pool_mark_open(pool, i);
+    const unsigned int words = _pool_words(pool->slots);
+    for (unsigned int w = 0; w < words; w++) {
+        pool->free[w] = 0xFFFFFFFF;
+    }
+    /* Bits past the last slot stay clear so they are never handed out */
+    if (pool->slots % POOL_WORD_BITS) {
+        pool->free[words - 1] = (1u << (pool->slots % POOL_WORD_BITS)) - 1;
     }
 }
 
@@ -89,7 +102,7 @@ pool_destroy_user(block_pool* pool, void (*user_free)(void* ptr)) {
     pool->base = NULL;
     pool->size = 0;
     pool->slots = 0;
-    (*user_free)(pool->state);
+    (*user_free)(pool->free);
     (*user_free)(pool->format);
 }
 
@@ -98,8 +111,8 @@ pool_destroy(block_pool* pool) {
     pool->base = NULL;
     pool->size = 0;
     pool->slots = 0;
-    free(pool->state);
+    free(pool->free);
     free(pool->format);
-    pool->state = NULL;
+    pool->free = NULL;
     pool->format = NULL;
 }
@@ -17,12 +17,14 @@ typedef struct slot_format {
     uint32_t format;
 } slot_format;
 
+#define POOL_WORD_BITS (32)
+
 typedef struct block_pool {
     void* base;
     unsigned int size;
     unsigned int slots;
     unsigned int slot_size;
-    unsigned char* state;
+    uint32_t* free; /* Bit per slot, set while it is free */
     slot_format* format;
 } block_pool;
 
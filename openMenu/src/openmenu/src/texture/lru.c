@@ -1,5 +1,4 @@
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 
 #include "lru.h"
@@ -10,17 +9,84 @@
 #define DBG_PRINT(...)
 #endif
 
-/* Missing on sh-elf-gcc 9.1 ? */
-char* strdup(const char* s);
+/* Fixed capacity LRU, called for every tile drawn so it never touches the heap.
+ * Entries sit in the cache itself, an open addressed table finds them by key
+ * and a doubly linked list through them keeps recency, head most recent */
 
-// this is an example of how to do a LRU cache in C using uthash
-// http://uthash.sourceforge.net/
-// by Jehiah Czebotar 2011 - jehiah@gmail.com
-// this code is in the public domain http://unlicense.org/
+#define LRU_ENTRY(cache, link) (&(cache)->entries[(link) - 1])
+
+static uint32_t
+lru_hash(const char* key) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < LRU_KEY_LEN && key[i]; i++) {
+        hash = (hash ^ (unsigned char)key[i]) * 16777619u;
+    }
+    return hash & (LRU_TABLE_SIZE - 1);
+}
+
+/* Table slot holding key, or the free slot it would go in */
+static uint32_t
+lru_slot(const cache_instance* cache, const char* key) {
+    uint32_t pos = lru_hash(key);
+    while (cache->table[pos] && strncmp(LRU_ENTRY(cache, cache->table[pos])->key, key, LRU_KEY_LEN)) {
+        pos = (pos + 1) & (LRU_TABLE_SIZE - 1);
+    }
+    return pos;
+}
+
+/* Shifts back whatever probed past pos, so lookups never need tombstones */
+static void
+lru_table_remove(cache_instance* cache, uint32_t pos) {
+    const uint32_t mask = LRU_TABLE_SIZE - 1;
+    uint32_t hole = pos;
+    for (uint32_t next = (pos + 1) & mask; cache->table[next]; next = (next + 1) & mask) {
+        const uint32_t home = lru_hash(LRU_ENTRY(cache, cache->table[next])->key);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            cache->table[hole] = cache->table[next];
+            hole = next;
+        }
+    }
+    cache->table[hole] = 0;
+}
+
+static void
+lru_unlink(cache_instance* cache, uint8_t link) {
+    struct CacheEntry* entry = LRU_ENTRY(cache, link);
+    if (entry->prev) {
+        LRU_ENTRY(cache, entry->prev)->next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next) {
+        LRU_ENTRY(cache, entry->next)->prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+}
+
+static void
+lru_push_front(cache_instance* cache, uint8_t link) {
+    struct CacheEntry* entry = LRU_ENTRY(cache, link);
+    entry->prev = 0;
+    entry->next = cache->head;
+    if (cache->head) {
+        LRU_ENTRY(cache, cache->head)->prev = link;
+    } else {
+        cache->tail = link;
+    }
+    cache->head = link;
+}
 
 void
 cache_set_size(cache_instance* cache, int size) {
-    cache->cache_max_size = size;
+    if (size > LRU_MAX_ENTRIES) {
+        printf("%s %d entries asked for, only %d fit\n", __func__, size, LRU_MAX_ENTRIES);
+        size = LRU_MAX_ENTRIES;
+    }
+    cache->cache_max_size = size > 0 ? size : 0;
+    cache->count = 0;
+    cache->head = cache->tail = 0;
+    memset(cache->table, 0, sizeof(cache->table));
 }
 
 void
@@ -40,80 +106,87 @@ cache_callback_del(cache_instance* cache, user_del_cb callback) {
 
 int
 find_in_cache(cache_instance* cache, const char* key) {
-    struct CacheEntry* entry;
     if (!cache || !key) {
         return -1;
     }
-    HASH_FIND_STR(cache->cache, key, entry);
-    if (entry) {
-        // remove it (so the subsequent add will throw it on the front of the list)
-        if (entry != cache->cache) {
-            HASH_DELETE(hh, cache->cache, entry);
-            HASH_ADD_STR(cache->cache, key, entry);
-        }
-        return entry->value;
+    const uint8_t link = cache->table[lru_slot(cache, key)];
+    if (!link) {
+        return -1;
+    }
+    if (cache->head != link) {
+        lru_unlink(cache, link);
+        lru_push_front(cache, link);
+    }
+    return LRU_ENTRY(cache, link)->value;
+}
+
+int
+peek_in_cache(const cache_instance* cache, const char* key) {
+    if (!cache || !key) {
+        return -1;
     }
-    return -1;
+    const uint8_t link = cache->table[lru_slot(cache, key)];
+    return link ? LRU_ENTRY(cache, link)->value : -1;
 }
 
 void
 add_to_cache(cache_instance* cache, const char* key, int value) {
     DBG_PRINT("+%s( %s )\n", __func__, key);
-    struct CacheEntry *entry, *tmp_entry, *new_entry;
     unsigned int cb_return = 0xFFFFFFFF;
+    uint8_t link;
+
+    if (!cache || !key || !cache->cache_max_size) {
+        return;
+    }
+    if (strlen(key) >= LRU_KEY_LEN) {
+        printf("%s key %s too long\n", __func__, key);
+        return;
+    }
+    if (find_in_cache(cache, key) != -1) {
+        /* Already cached, find_in_cache made it the most recent */
+        return;
+    }
+
+    if (cache->count < cache->cache_max_size) {
+        link = (uint8_t)++cache->count;
+    } else {
+        /* Full, the least recently used entry makes room before the add callback runs */
+        link = cache->tail;
+        struct CacheEntry* entry = LRU_ENTRY(cache, link);
+        DBG_PRINT("-del_from_cache( %s )\n", entry->key);
+        if (cache->callback_del) {
+            (*cache->callback_del)(entry->key, &entry->value, cache->callback_data);
+        }
+        lru_unlink(cache, link);
+        lru_table_remove(cache, lru_slot(cache, entry->key));
+    }
 
     /* Call user function */
     if (cache->callback_add) {
         cb_return = (*cache->callback_add)(key, cache->callback_data);
     }
-
-    entry = calloc(1, sizeof(struct CacheEntry));
-    if (!entry) {
-        printf("%s no free memory\n", __func__);
-        return;
-    }
-    entry->key = strdup(key);
     if (cb_return != 0xFFFFFFFF) {
         value = cb_return;
     }
+
+    struct CacheEntry* entry = LRU_ENTRY(cache, link);
+    strncpy(entry->key, key, LRU_KEY_LEN);
     entry->value = value;
-    new_entry = entry;
-    HASH_ADD_STR(cache->cache, key, entry);
-
-    // prune the cache to cache_max_size
-    if (HASH_COUNT(cache->cache) > cache->cache_max_size) {
-        HASH_ITER(hh, cache->cache, entry, tmp_entry) {
-            // prune the first entry (loop is based on insertion order so this deletes
-            // the oldest item)
-            HASH_DELETE(hh, cache->cache, entry);
-            DBG_PRINT("-del_from_cache( %s )\n", key);
-            if (cache->callback_del) {
-                (*cache->callback_del)(entry->key, &entry->value, cache->callback_data);
-                if (cache->callback_add) {
-                    cb_return = (*cache->callback_add)(key, cache->callback_data);
-                }
-                new_entry->value = cb_return;
-            }
-
-            free(entry->key);
-            free(entry);
-            break;
-        }
-    }
+    cache->table[lru_slot(cache, key)] = link;
+    lru_push_front(cache, link);
 }
 
 void
 empty_cache(cache_instance* cache) {
-    struct CacheEntry *entry, *tmp_entry;
-    HASH_ITER(hh, cache->cache, entry, tmp_entry) {
-        // prune all entries
-        HASH_DELETE(hh, cache->cache, entry);
-        DBG_PRINT("-del_from_cache( %s )\n", key);
+    /* Least recently used first */
+    for (uint8_t link = cache->tail; link; link = LRU_ENTRY(cache, link)->prev) {
+        struct CacheEntry* entry = LRU_ENTRY(cache, link);
+        DBG_PRINT("-del_from_cache( %s )\n", entry->key);
         if (cache->callback_del) {
             (*cache->callback_del)(entry->key, &entry->value, cache->callback_data);
         }
-
-        free(entry->key);
-        free(entry);
     }
+    cache->count = 0;
+    cache->head = cache->tail = 0;
+    memset(cache->table, 0, sizeof(cache->table));
 }
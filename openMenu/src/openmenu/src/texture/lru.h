@@ -1,30 +1,44 @@
 #pragma once
 
-#include <uthash.h>
+#include <stdint.h>
 
 /* Function callbacks */
 typedef unsigned int (*user_add_cb)(const char* key, void* user);
 typedef unsigned int (*user_del_cb)(const char* key, void* value, void* user);
 
+#define LRU_KEY_LEN     (12) /* Inline key, NUL included */
+#define LRU_MAX_ENTRIES (64)
+#define LRU_TABLE_SIZE  (LRU_MAX_ENTRIES * 2) /* Power of two, at most half full */
+
+/* Entries never move. Links and table slots hold an entry index + 1, 0 for none */
 struct CacheEntry {
-    char* key;
+    char key[LRU_KEY_LEN];
     int value;
-    UT_hash_handle hh;
+    uint8_t prev; /* Towards the most recently used */
+    uint8_t next; /* Towards the least recently used */
 };
 
+/* Fixed capacity, nothing is allocated. All zero is an empty cache */
 typedef struct cache_instance {
     unsigned int cache_max_size;
     void* callback_data;
     user_add_cb callback_add;
     user_del_cb callback_del;
-    struct CacheEntry* cache;
+    unsigned int count;
+    uint8_t head; /* Most recently used */
+    uint8_t tail; /* Least recently used, evicted first */
+    uint8_t table[LRU_TABLE_SIZE]; /* Open addressed by key */
+    struct CacheEntry entries[LRU_MAX_ENTRIES];
 } cache_instance;
 
+/* Also empties the cache, without calling back */
 void cache_set_size(cache_instance* cache, int size);
 void cache_callback_userdata(cache_instance* cache, void* user);
 void cache_callback_add(cache_instance* cache, user_add_cb callback);
 void cache_callback_del(cache_instance* cache, user_del_cb callback);
 
 int find_in_cache(cache_instance* cache, const char* key);
+/* Same answer as find_in_cache, leaves the order alone */
+int peek_in_cache(const cache_instance* cache, const char* key);
 void add_to_cache(cache_instance* cache, const char* key, int value);
 void empty_cache(cache_instance* cache);
@@ -0,0 +1,37 @@
+/*
+ * File: txr_binding.c
+ * Project: texture
+ * File Created: Friday, 16th October 2026 4:10:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License,
+ * http://www.opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <backend/gd_list.h>
+
+#include "txr_binding.h"
+
+/* Starts at 1 so a zeroed binding never matches */
+static unsigned int txr_gen = 1;
+
+int
+txr_binding_hit(const txr_binding* binding, int index) {
+    return (binding->index == index) && (binding->txr_gen == txr_gen) && (binding->list_gen == list_generation());
+}
+
+void
+txr_binding_set(txr_binding* binding, int index) {
+    binding->list_gen = list_generation();
+    binding->txr_gen = txr_gen;
+    binding->index = index;
+}
+
+void
+txr_binding_reset(txr_binding* binding) {
+    binding->index = -1;
+}
+
+void
+txr_binding_invalidate(void) {
+    txr_gen++;
+}
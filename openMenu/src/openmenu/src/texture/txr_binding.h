@@ -0,0 +1,27 @@
+/*
+ * File: txr_binding.h
+ * Project: texture
+ * File Created: Friday, 16th October 2026 4:10:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+
+#pragma once
+
+/* Which list item a UI last looked up into one of its images. While it holds,
+ * the image is drawn again as is, with no texture cache or DAT lookup */
+typedef struct txr_binding {
+    unsigned int list_gen;
+    unsigned int txr_gen;
+    int index; /* In list_get, -1 for nothing */
+} txr_binding;
+
+/* img still holds index: same list, same item and nothing evicted since. All zero never hits */
+int txr_binding_hit(const txr_binding* binding, int index);
+/* After a lookup returned 0, covers still being read are looked up again next frame */
+void txr_binding_set(txr_binding* binding, int index);
+/* When the image is filled some other way */
+void txr_binding_reset(txr_binding* binding);
+
+/* The texture cache calls this whenever a slot is freed, every binding then misses once */
+void txr_binding_invalidate(void);
@@ -10,38 +10,71 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <dc/pvr.h>
 
 #include <backend/dat_format.h>
+#include <backend/gd_item.h>
+#include <backend/gd_list.h>
 #include "ui/draw_kos.h"
 #include "ui/draw_prototypes.h"
 #include "block_pool.h"
 #include "lru.h"
-#include <texture/serial_sanitize.h>
+#include "txr_binding.h"
+#include "txr_prefetch.h"
 
 #include "txr_manager.h"
 
-/* CFG for small pvr pool (128x128 16bit, 16 spaces) */
-#define SM_SLOT_NUM  (16)
-#define SM_SLOT_SIZE (128 * 128 * 2)
-#define SM_POOL_SIZE (SM_SLOT_NUM * SM_SLOT_SIZE * sizeof(char))
+/* Covers share one VRAM region split into size classes, each a block_pool with
+ * its own LRU. A texture goes in the smallest class its bytes fit, so a VQ
+ * cover takes a 128x128 slot rather than a 256x256 one. There is no 512x512
+ * class, one slot is 512KB and a share of TXR_POOL_MAX would never hold it */
+#define TXR_NUM_CLASSES  (3)
+#define TXR_SHARE_TOTAL  (16)
+#define TXR_POOL_MIN     (1024 * 1024) /* What the fixed 16 small + 4 large pools took */
+#define TXR_POOL_MAX     (2 * 1024 * 1024)
+#define TXR_VRAM_RESERVE (TEXMAN_BUFFER_SIZE + (512 * 1024)) /* draw_init scratch and theme art, taken after us */
 
-/* CFG for large pvr pool (256x256 16bit, 4 spaces) */
-#define LG_SLOT_NUM  (4)
-#define LG_SLOT_SIZE (256 * 256 * 2)
-#define LG_POOL_SIZE (LG_SLOT_NUM * LG_SLOT_SIZE * sizeof(char))
+/* Chunks read ahead into RAM, a grid page of icons and the focused box plus neighbours */
+#define SM_STAGING_NUM (16)
+#define LG_STAGING_NUM (3)
+#define LG_PREFETCH_AHEAD (2) /* Boxes hinted ahead of the selection */
 
-typedef struct dat_system {
+typedef struct txr_class {
+    uint32_t dim;   /* Square 16bit texture a slot holds */
+    uint32_t share; /* Of TXR_SHARE_TOTAL, what it cannot use in whole slots goes to the next class down */
     cache_instance cache;
     block_pool pool;
+} txr_class;
+
+static txr_class classes[TXR_NUM_CLASSES] = {
+    {.dim = 64, .share = 1},
+    {.dim = 128, .share = 6},
+    {.dim = 256, .share = 9},
+};
+static void* class_vram;
+
+/* Where one item's art lives, an empty key when neither DAT has it */
+typedef struct txr_ref {
+    char key[LRU_KEY_LEN];
+    uint32_t chunk_num;
+    uint8_t addon; /* Else primary */
+    uint8_t cls;   /* Class it was last cached in, looked in first */
+} txr_ref;
+
+typedef struct dat_system {
+    char tag; /* Leads its cache keys, both systems share the classes */
+    prefetch_queue staging;
     struct dat_file addon;
     struct dat_file primary;
+    txr_ref* refs; /* By list_slot_index, from txr_resolve_list */
+    int num_refs;
 } dat_system;
 
-static dat_system icon_system;
-static dat_system box_system;
+static dat_system icon_system = {.tag = 'I'};
+static dat_system box_system = {.tag = 'B'};
 
 unsigned int
 block_pool_add_cb(const char* key, void* user) {
@@ -63,13 +96,20 @@ block_pool_del_cb(const char* key, void* value, void* user) {
     block_pool* pool = (block_pool*)user;
     unsigned int slot_num = *(unsigned int*)value;
     pool_dealloc_slot(pool, slot_num);
+    /* Whatever a UI has bound may be in this slot */
+    txr_binding_invalidate();
     return 0;
 }
 
+/* Staging holds the larger chunk of the pair */
+static uint32_t
+txr_chunk_size(const dat_system* system) {
+    return (system->addon.chunk_size > system->primary.chunk_size) ? system->addon.chunk_size
+                                                                   : system->primary.chunk_size;
+}
+
 int
 txr_load_DATs(void) {
-    serial_sanitizer_init(); /*@Todo: Move this */
-
     DAT_init(&icon_system.addon);
     DAT_init(&icon_system.primary);
     DAT_init(&box_system.addon);
@@ -80,99 +120,306 @@ txr_load_DATs(void) {
     DAT_load_parse(&icon_system.addon, "ICON_EX.DAT");
     DAT_load_parse(&box_system.addon, "BOX_EX.DAT");
 
-    return 0;
-}
-
-int
-txr_create_small_pool(void) {
-    void* buffer = pvr_mem_malloc(SM_POOL_SIZE);
-    pool_create(&icon_system.pool, buffer, SM_POOL_SIZE, SM_SLOT_NUM);
-    icon_system.cache.cache = NULL;
-    cache_set_size(&icon_system.cache, SM_SLOT_NUM);
-    cache_callback_userdata(&icon_system.cache, &icon_system.pool);
-    cache_callback_add(&icon_system.cache, block_pool_add_cb);
-    cache_callback_del(&icon_system.cache, block_pool_del_cb);
+    /* Without staging or the worker, covers load in the frame as before */
+    if (prefetch_queue_create(&icon_system.staging, txr_chunk_size(&icon_system), SM_STAGING_NUM)
+        || prefetch_queue_create(&box_system.staging, txr_chunk_size(&box_system), LG_STAGING_NUM)
+        || prefetch_start(NULL)) {
+        prefetch_queue_destroy(&icon_system.staging);
+        prefetch_queue_destroy(&box_system.staging);
+    }
 
     return 0;
 }
 
-/* pool_destroy_user(&pvr_small, pvr_mem_free); */
+void
+txr_stop_prefetch(void) {
+    prefetch_stop();
+}
 
 int
-txr_create_large_pool(void) {
-    void* buffer = pvr_mem_malloc(LG_POOL_SIZE);
-    pool_create(&box_system.pool, buffer, LG_POOL_SIZE, LG_SLOT_NUM);
-    box_system.cache.cache = NULL;
-    cache_set_size(&box_system.cache, LG_SLOT_NUM);
-    cache_callback_userdata(&box_system.cache, &box_system.pool);
-    cache_callback_add(&box_system.cache, block_pool_add_cb);
-    cache_callback_del(&box_system.cache, block_pool_del_cb);
+txr_create_pool(void) {
+    const uint32_t avail = (uint32_t)pvr_mem_available();
+    uint32_t budget = (avail > TXR_VRAM_RESERVE) ? avail - TXR_VRAM_RESERVE : 0;
+    if (budget > TXR_POOL_MAX) {
+        budget = TXR_POOL_MAX;
+    } else if (budget < TXR_POOL_MIN) {
+        budget = TXR_POOL_MIN;
+    }
+    class_vram = pvr_mem_malloc(budget);
+    if (!class_vram) {
+        printf("%s no free memory\n", __func__);
+        return 1;
+    }
+
+    /* Largest first, so the rounding left over ends up as small slots */
+    uintptr_t base = (uintptr_t)class_vram + budget;
+    uint32_t carry = 0;
+    for (int c = TXR_NUM_CLASSES - 1; c >= 0; c--) {
+        txr_class* cls = &classes[c];
+        const uint32_t slot_size = cls->dim * cls->dim * 2;
+        uint32_t slots = ((budget / TXR_SHARE_TOTAL * cls->share) + carry) / slot_size;
+        if (slots > LRU_MAX_ENTRIES) {
+            slots = LRU_MAX_ENTRIES;
+        }
+        carry += (budget / TXR_SHARE_TOTAL * cls->share) - (slots * slot_size);
+        base -= slots * slot_size;
+
+        cache_set_size(&cls->cache, slots);
+        if (slots) {
+            pool_create(&cls->pool, (void*)base, slots * slot_size, slots);
+            cache_callback_userdata(&cls->cache, &cls->pool);
+            cache_callback_add(&cls->cache, block_pool_add_cb);
+            cache_callback_del(&cls->cache, block_pool_del_cb);
+        }
+        printf("TXR: %lux%lu class %lu slots\n", (unsigned long)cls->dim, (unsigned long)cls->dim,
+               (unsigned long)slots);
+    }
     return 0;
 }
 
 void
-txr_empty_small_pool(void) {
-    empty_cache(&icon_system.cache);
-    pool_dealloc_all(&icon_system.pool);
+txr_empty_pool(void) {
+    for (int c = 0; c < TXR_NUM_CLASSES; c++) {
+        if (classes[c].pool.slots) {
+            empty_cache(&classes[c].cache);
+            pool_dealloc_all(&classes[c].pool);
+        }
+    }
 }
 
-void
-txr_empty_large_pool(void) {
-    empty_cache(&box_system.cache);
-    pool_dealloc_all(&box_system.pool);
+/* Smallest class with slots that holds size bytes, NULL if none does */
+static txr_class*
+txr_class_for(uint32_t size) {
+    for (int c = 0; c < TXR_NUM_CLASSES; c++) {
+        if (classes[c].pool.slots && size <= classes[c].pool.slot_size) {
+            return &classes[c];
+        }
+    }
+    return NULL;
 }
 
+/* Slot holding key in whichever class has it, starting with hint, -1 if none. peek leaves the LRU order alone */
 static int
-txr_get_from_dat_set(const char* id, struct image* img, dat_system* system) {
-    void* txr_ptr;
-    int slot_num;
-    const char* id_santized = serial_santize_art(id);
+txr_find_cached(const char* key, int hint, txr_class** owner, int peek) {
+    for (int i = 0; i < TXR_NUM_CLASSES; i++) {
+        txr_class* cls = &classes[(hint + i) % TXR_NUM_CLASSES];
+        const int slot_num = peek ? peek_in_cache(&cls->cache, key) : find_in_cache(&cls->cache, key);
+        if (slot_num != -1) {
+            *owner = cls;
+            return slot_num;
+        }
+    }
+    return -1;
+}
+
+/* Uploads a chunk read from a DAT, NULL when the read failed. Returns the class it went in */
+static uint8_t
+txr_upload_chunk(const char* key, const void* chunk, struct image* img) {
+    uint32_t width, height, format;
+    const uint32_t size = chunk ? pvr_get_texture_size(chunk, &width, &height, &format) : 0;
+    txr_class* cls = size ? txr_class_for(size) : NULL;
+    if (!cls) {
+        /* Failed or too big for any class, a zero format in the smallest keeps it from being read again */
+        draw_load_missing_icon(img);
+        cls = txr_class_for(0);
+        if (cls) {
+            add_to_cache(&cls->cache, key, 0);
+            pool_set_slot_format(&cls->pool, find_in_cache(&cls->cache, key), 0, 0, 0);
+        }
+        return cls ? (uint8_t)(cls - classes) : 0;
+    }
+
+    add_to_cache(&cls->cache, key, 0);
+    const int slot_num = find_in_cache(&cls->cache, key);
+    draw_load_texture_from_chunk_to_buffer(chunk, img, pool_get_slot_addr(&cls->pool, slot_num));
+    pool_set_slot_format(&cls->pool, slot_num, img->width, img->height, img->format);
+    return (uint8_t)(cls - classes);
+}
 
-    /* Initially check addon then fall back to regular */
-    uint32_t temp_offset = DAT_get_offset_by_ID(&system->addon, id_santized);
+/* Initially check addon then fall back to regular, an empty key if neither has id */
+static void
+txr_resolve(const char* id, const dat_system* system, txr_ref* ref) {
+    memset(ref, 0, sizeof(txr_ref));
+    uint32_t temp_offset = DAT_get_offset_by_ID(&system->addon, id);
     const dat_file* dat_source = &system->addon;
     if (!temp_offset) {
-        temp_offset = DAT_get_offset_by_ID(&system->primary, id_santized);
+        temp_offset = DAT_get_offset_by_ID(&system->primary, id);
         dat_source = &system->primary;
         if (!temp_offset) {
-            dat_source = NULL;
+            return;
+        }
+    }
+
+    /* Key on where the chunk lives, deduplicated IDs then share one slot */
+    ref->addon = (dat_source == &system->addon);
+    ref->chunk_num = DAT_get_index_by_ID(dat_source, id);
+    snprintf(ref->key, sizeof(ref->key), "%c%c%08lX", system->tag, ref->addon ? 'A' : 'P',
+             (unsigned long)temp_offset);
+}
+
+/* The item's entry in the table, folders and other built in entries are resolved into scratch */
+static txr_ref*
+txr_ref_for(const gd_item* item, const dat_system* system, txr_ref* scratch) {
+    const int idx = list_slot_index(item);
+    if (idx >= 0 && idx < system->num_refs) {
+        return &system->refs[idx];
+    }
+    txr_resolve(gd_item_art_id(item), system, scratch);
+    return scratch;
+}
+
+int
+txr_resolve_list(void) {
+    dat_system* systems[] = {&icon_system, &box_system};
+    const int count = list_slot_count();
+
+    for (int s = 0; s < 2; s++) {
+        dat_system* system = systems[s];
+        free(system->refs);
+        system->refs = NULL;
+        system->num_refs = 0;
+        if (!count) {
+            continue;
+        }
+        system->refs = malloc(count * sizeof(txr_ref));
+        if (!system->refs) {
+            printf("%s no free memory\n", __func__);
+            return 1;
         }
+        for (int i = 0; i < count; i++) {
+            txr_resolve(gd_item_art_id(list_slot_get(i)), system, &system->refs[i]);
+        }
+        system->num_refs = count;
     }
+    return 0;
+}
 
-    /* check if exists in DAT and if not, return missing image */
-    if (!dat_source) {
+static int
+txr_get_from_ref(txr_ref* ref, struct image* img, dat_system* system) {
+    txr_class* cls;
+
+    /* not in either DAT, return missing image */
+    if (!ref->key[0]) {
         draw_load_missing_icon(img);
         return 0;
     }
-    slot_num = find_in_cache(&system->cache, id_santized);
-    if (slot_num == -1) {
-        add_to_cache(&system->cache, id_santized, 0);
-        slot_num = find_in_cache(&system->cache, id_santized);
-        txr_ptr = pool_get_slot_addr(&system->pool, slot_num);
 
-        /* now load the texture into vram */
-        draw_load_texture_from_DAT_to_buffer(dat_source, id_santized, img, txr_ptr);
-        pool_set_slot_format(&system->pool, slot_num, img->width, img->height, img->format);
-    } else {
-        const slot_format* fmt = pool_get_slot_format(&system->pool, slot_num);
+    const int slot_num = txr_find_cached(ref->key, ref->cls, &cls, 0);
+    if (slot_num != -1) {
+        ref->cls = (uint8_t)(cls - classes);
+        const slot_format* fmt = pool_get_slot_format(&cls->pool, slot_num);
+        if (!fmt->width) {
+            /* Read failed, keeps its slot so it is not read again */
+            draw_load_missing_icon(img);
+            return 0;
+        }
         img->width = fmt->width;
         img->height = fmt->height;
         img->format = fmt->format;
-        img->texture = pool_get_slot_addr(&system->pool, slot_num);
+        img->texture = pool_get_slot_addr(&cls->pool, slot_num);
+        return 0;
     }
+
+    const dat_file* dat_source = ref->addon ? &system->addon : &system->primary;
+    if (!prefetch_running()) {
+        /* now load the texture into vram */
+        void* chunk = pvr_get_internal_buffer();
+        ref->cls = txr_upload_chunk(ref->key, DAT_read_file_by_num(dat_source, ref->chunk_num, chunk) ? chunk : NULL,
+                                    img);
+        return 0;
+    }
+
+    /* The worker reads it, until then the tile shows as missing */
+    const int staged = prefetch_fetch(&system->staging, dat_source, ref->chunk_num, ref->key);
+    if (staged == -1) {
+        draw_load_missing_icon(img);
+        return 1;
+    }
+    ref->cls = txr_upload_chunk(
+        ref->key, prefetch_slot_ok(&system->staging, staged) ? prefetch_slot_data(&system->staging, staged) : NULL,
+        img);
+    prefetch_release(&system->staging, staged);
     return 0;
 }
 
+static void
+txr_prefetch_from_dat_set(const gd_item* const* items, int count, dat_system* system) {
+    txr_class* cls;
+    txr_ref scratch;
+
+    if (!prefetch_running()) {
+        return;
+    }
+    prefetch_demote(&system->staging);
+    for (int i = 0; i < count; i++) {
+        const txr_ref* ref = txr_ref_for(items[i], system, &scratch);
+        if (ref->key[0] && txr_find_cached(ref->key, ref->cls, &cls, 1) == -1) {
+            prefetch_hint(&system->staging, ref->addon ? &system->addon : &system->primary, ref->chunk_num,
+                          ref->key);
+        }
+    }
+}
+
 /*
 called with "T1121.pvr" and a pointer to pointer to vram
 returns pointer to use for texture upload/reference
  */
 int
 txr_get_small(const char* id, struct image* img) {
-    return txr_get_from_dat_set(id, img, &icon_system);
+    txr_ref ref;
+    txr_resolve(id, &icon_system, &ref);
+    return txr_get_from_ref(&ref, img, &icon_system);
 }
 
 int
 txr_get_large(const char* id, struct image* img) {
-    return txr_get_from_dat_set(id, img, &box_system);
+    txr_ref ref;
+    txr_resolve(id, &box_system, &ref);
+    return txr_get_from_ref(&ref, img, &box_system);
+}
+
+int
+txr_get_small_item(const gd_item* item, struct image* img) {
+    txr_ref scratch;
+    return txr_get_from_ref(txr_ref_for(item, &icon_system, &scratch), img, &icon_system);
+}
+
+int
+txr_get_large_item(const gd_item* item, struct image* img) {
+    txr_ref scratch;
+    return txr_get_from_ref(txr_ref_for(item, &box_system, &scratch), img, &box_system);
+}
+
+void
+txr_prefetch_small(const gd_item* const* items, int count) {
+    txr_prefetch_from_dat_set(items, count, &icon_system);
+}
+
+void
+txr_prefetch_large(const gd_item* const* items, int count) {
+    txr_prefetch_from_dat_set(items, count, &box_system);
+}
+
+void
+txr_prefetch_large_around(const gd_item* const* list, int len, int idx, int* last) {
+    if (idx == *last) {
+        return;
+    }
+    const int step = (idx > *last) ? 1 : -1;
+    const gd_item* items[LG_PREFETCH_AHEAD];
+    int count = 0;
+    *last = idx;
+
+    for (int i = 1; i <= LG_PREFETCH_AHEAD; i++) {
+        const int next = idx + (step * i);
+        if (next < 0 || next >= len) {
+            break;
+        }
+        /* Folders have no art of their own */
+        if (!strncmp(list[next]->disc, "DIR", 3)) {
+            continue;
+        }
+        items[count++] = list[next];
+    }
+    txr_prefetch_large(items, count);
 }
@@ -11,13 +11,31 @@
 #pragma once
 
 struct image;
+struct gd_item;
 
-int txr_create_small_pool(void);
-int txr_create_large_pool(void);
-void txr_empty_small_pool(void);
-void txr_empty_large_pool(void);
+/* Sizes each class from the VRAM free before draw_init */
+int txr_create_pool(void);
+void txr_empty_pool(void);
 
-int txr_load_DATs(void); /* Loads our DAT files full of images */
+int txr_load_DATs(void); /* Loads our DAT files full of images, starts reading covers ahead */
+void txr_stop_prefetch(void); /* Before anything else uses the disc */
 
+/* Finds every loaded item's art once, after list_read_default and txr_load_DATs */
+int txr_resolve_list(void);
+
+/* List items, looked up in the table built by txr_resolve_list. All of these
+ * return 1 while the cover is still being read and img holds the missing icon */
+int txr_get_small_item(const struct gd_item* item, struct image* img);
+int txr_get_large_item(const struct gd_item* item, struct image* img);
+
+/* id is searched for in the DATs on every call, for art not tied to a list item */
 int txr_get_small(const char* id, struct image* img);
 int txr_get_large(const char* id, struct image* img);
+
+/* Covers not read yet show as missing until the worker has them. When the
+ * visible items change, pass the items likely to be shown next, nearest first */
+void txr_prefetch_small(const struct gd_item* const* items, int count);
+void txr_prefetch_large(const struct gd_item* const* items, int count);
+/* Hints the large art of the items the selection at idx is moving towards, folders are skipped.
+ * last holds idx from the previous call, nothing is hinted until it changes, -1 starts over */
+void txr_prefetch_large_around(const struct gd_item* const* list, int len, int idx, int* last);
@@ -0,0 +1,255 @@
+/*
+ * File: txr_prefetch.c
+ * Project: texture
+ * File Created: Friday, 16th October 2026 12:40:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License,
+ * http://www.opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <backend/dat_format.h>
+
+#include "txr_prefetch.h"
+
+/* Seeking and reading a cover takes several frames on the console, so a worker
+ * does it into RAM and the frame only copies finished chunks into VRAM. One
+ * lock covers every slot state, the buffers themselves belong to whoever the
+ * state says: LOADING to the worker, READY to the main thread */
+
+static pthread_mutex_t prefetch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t prefetch_wake = PTHREAD_COND_INITIALIZER;
+static pthread_t prefetch_thread;
+static int prefetch_started;
+static int prefetch_quit;
+static prefetch_read_cb prefetch_read;
+
+static prefetch_queue* queues[PREFETCH_MAX_QUEUES];
+static int num_queues;
+static uint32_t prefetch_order;
+static uint32_t prefetch_generation;
+
+int
+prefetch_queue_create(prefetch_queue* queue, uint32_t chunk_size, unsigned int slots) {
+    memset(queue, 0, sizeof(prefetch_queue));
+    if (slots > PREFETCH_MAX_SLOTS) {
+        slots = PREFETCH_MAX_SLOTS;
+    }
+    if (!chunk_size || !slots || num_queues == PREFETCH_MAX_QUEUES) {
+        return 1;
+    }
+    queue->buffers = malloc(chunk_size * slots);
+    if (!queue->buffers) {
+        printf("%s no free memory\n", __func__);
+        return 1;
+    }
+    queue->chunk_size = chunk_size;
+    queue->slots = slots;
+    queues[num_queues++] = queue;
+    return 0;
+}
+
+void
+prefetch_queue_destroy(prefetch_queue* queue) {
+    for (int i = 0; i < num_queues; i++) {
+        if (queues[i] == queue) {
+            queues[i] = queues[--num_queues];
+            break;
+        }
+    }
+    free(queue->buffers);
+    memset(queue, 0, sizeof(prefetch_queue));
+}
+
+/* Urgent first, then the newest generation, then in the order asked for */
+static int
+prefetch_before(const prefetch_slot* a, const prefetch_slot* b) {
+    if (a->urgent != b->urgent) {
+        return a->urgent > b->urgent;
+    }
+    if (a->generation != b->generation) {
+        return a->generation > b->generation;
+    }
+    return a->order < b->order;
+}
+
+static prefetch_slot*
+prefetch_next(prefetch_queue** owner) {
+    prefetch_slot* best = NULL;
+    for (int q = 0; q < num_queues; q++) {
+        for (unsigned int i = 0; i < queues[q]->slots; i++) {
+            prefetch_slot* slot = &queues[q]->slot[i];
+            if (slot->state == PREFETCH_QUEUED && (!best || prefetch_before(slot, best))) {
+                best = slot;
+                *owner = queues[q];
+            }
+        }
+    }
+    return best;
+}
+
+static void*
+prefetch_worker(void* param) {
+    (void)param;
+    pthread_mutex_lock(&prefetch_lock);
+    while (!prefetch_quit) {
+        prefetch_queue* queue = NULL;
+        prefetch_slot* slot = prefetch_next(&queue);
+        if (!slot) {
+            pthread_cond_wait(&prefetch_wake, &prefetch_lock);
+            continue;
+        }
+        slot->state = PREFETCH_LOADING;
+        void* buf = queue->buffers + ((slot - queue->slot) * queue->chunk_size);
+        const struct dat_file* bin = slot->bin;
+        const uint32_t chunk_num = slot->chunk_num;
+        pthread_mutex_unlock(&prefetch_lock);
+
+        const int ok = (*prefetch_read)(bin, chunk_num, buf);
+
+        pthread_mutex_lock(&prefetch_lock);
+        slot->ok = (uint8_t)(ok != 0);
+        slot->state = PREFETCH_READY;
+    }
+    pthread_mutex_unlock(&prefetch_lock);
+    return NULL;
+}
+
+int
+prefetch_start(prefetch_read_cb read) {
+    if (prefetch_started) {
+        return 0;
+    }
+    prefetch_read = read ? read : DAT_read_file_by_num;
+    prefetch_quit = 0;
+    if (pthread_create(&prefetch_thread, NULL, prefetch_worker, NULL)) {
+        printf("%s could not start worker, covers load in the frame\n", __func__);
+        return 1;
+    }
+    prefetch_started = 1;
+    return 0;
+}
+
+void
+prefetch_stop(void) {
+    if (!prefetch_started) {
+        return;
+    }
+    pthread_mutex_lock(&prefetch_lock);
+    prefetch_quit = 1;
+    pthread_cond_signal(&prefetch_wake);
+    pthread_mutex_unlock(&prefetch_lock);
+    pthread_join(prefetch_thread, NULL);
+    prefetch_started = 0;
+
+    /* Nothing will read what is still queued */
+    for (int q = 0; q < num_queues; q++) {
+        for (unsigned int i = 0; i < queues[q]->slots; i++) {
+            if (queues[q]->slot[i].state != PREFETCH_READY) {
+                queues[q]->slot[i].state = PREFETCH_FREE;
+            }
+        }
+    }
+}
+
+int
+prefetch_running(void) {
+    return prefetch_started;
+}
+
+static int
+prefetch_find(const prefetch_queue* queue, const char* key) {
+    for (unsigned int i = 0; i < queue->slots; i++) {
+        if (queue->slot[i].state != PREFETCH_FREE && !strncmp(queue->slot[i].key, key, PREFETCH_KEY_LEN)) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* A free slot, else the one the worker would read last, else -1. Hints leave urgent slots be */
+static int
+prefetch_victim(const prefetch_queue* queue, int urgent) {
+    int victim = -1;
+    for (unsigned int i = 0; i < queue->slots; i++) {
+        const prefetch_slot* slot = &queue->slot[i];
+        if (slot->state == PREFETCH_FREE) {
+            return (int)i;
+        }
+        if (slot->state == PREFETCH_LOADING || (slot->urgent && !urgent)) {
+            continue;
+        }
+        if (victim == -1 || prefetch_before(&queue->slot[victim], slot)) {
+            victim = (int)i;
+        }
+    }
+    return victim;
+}
+
+/* Caller holds the lock */
+static int
+prefetch_queue_key(prefetch_queue* queue, const struct dat_file* bin, uint32_t chunk_num, const char* key,
+                   int urgent) {
+    int slot_num = prefetch_find(queue, key);
+    if (slot_num != -1) {
+        /* Still wanted, read it with whatever else was just asked for */
+        prefetch_slot* slot = &queue->slot[slot_num];
+        slot->urgent |= (uint8_t)urgent;
+        slot->generation = prefetch_generation;
+        return slot_num;
+    }
+
+    slot_num = prefetch_victim(queue, urgent);
+    if (slot_num == -1) {
+        return -1;
+    }
+    prefetch_slot* slot = &queue->slot[slot_num];
+    strncpy(slot->key, key, PREFETCH_KEY_LEN - 1);
+    slot->key[PREFETCH_KEY_LEN - 1] = '\0';
+    slot->bin = bin;
+    slot->chunk_num = chunk_num;
+    slot->order = prefetch_order++;
+    slot->generation = prefetch_generation;
+    slot->urgent = (uint8_t)urgent;
+    slot->ok = 0;
+    slot->state = PREFETCH_QUEUED;
+    pthread_cond_signal(&prefetch_wake);
+    return slot_num;
+}
+
+int
+prefetch_fetch(prefetch_queue* queue, const struct dat_file* bin, uint32_t chunk_num, const char* key) {
+    pthread_mutex_lock(&prefetch_lock);
+    const int slot_num = prefetch_queue_key(queue, bin, chunk_num, key, 1);
+    const int ready = (slot_num != -1) && (queue->slot[slot_num].state == PREFETCH_READY);
+    pthread_mutex_unlock(&prefetch_lock);
+    return ready ? slot_num : -1;
+}
+
+void
+prefetch_hint(prefetch_queue* queue, const struct dat_file* bin, uint32_t chunk_num, const char* key) {
+    pthread_mutex_lock(&prefetch_lock);
+    prefetch_queue_key(queue, bin, chunk_num, key, 0);
+    pthread_mutex_unlock(&prefetch_lock);
+}
+
+void
+prefetch_demote(prefetch_queue* queue) {
+    pthread_mutex_lock(&prefetch_lock);
+    prefetch_generation++;
+    for (unsigned int i = 0; i < queue->slots; i++) {
+        queue->slot[i].urgent = 0;
+    }
+    pthread_mutex_unlock(&prefetch_lock);
+}
+
+void
+prefetch_release(prefetch_queue* queue, int slot) {
+    pthread_mutex_lock(&prefetch_lock);
+    queue->slot[slot].state = PREFETCH_FREE;
+    pthread_mutex_unlock(&prefetch_lock);
+}
@@ -0,0 +1,77 @@
+/*
+ * File: txr_prefetch.h
+ * Project: texture
+ * File Created: Friday, 16th October 2026 12:40:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+struct dat_file;
+
+#define PREFETCH_MAX_SLOTS  (16)
+#define PREFETCH_MAX_QUEUES (2)
+#define PREFETCH_KEY_LEN    (12) /* Same keys as the texture cache, NUL included */
+
+/* Reads one chunk into buf, returns 0 on failure. DAT_read_file_by_num unless replaced */
+typedef int (*prefetch_read_cb)(const struct dat_file* bin, uint32_t chunk_num, void* buf);
+
+enum PREFETCH_STATE {
+    PREFETCH_FREE = 0,
+    PREFETCH_QUEUED,  /* Waiting for the worker */
+    PREFETCH_LOADING, /* Worker is reading into it, only the worker touches it */
+    PREFETCH_READY,   /* Read, only the main thread touches it until released */
+};
+
+typedef struct prefetch_slot {
+    char key[PREFETCH_KEY_LEN];
+    const struct dat_file* bin;
+    uint32_t chunk_num;
+    uint32_t order;      /* Request order, oldest is recycled first */
+    uint32_t generation; /* Bumped by prefetch_demote, the worker reads the newest first */
+    uint8_t state;
+    uint8_t urgent; /* Wanted by something on screen, read before any hint */
+    uint8_t ok;     /* Read succeeded, READY only */
+} prefetch_slot;
+
+/* Staging buffers for one kind of chunk, read on the worker and uploaded by the main thread */
+typedef struct prefetch_queue {
+    uint32_t chunk_size;
+    unsigned int slots;
+    unsigned char* buffers;
+    prefetch_slot slot[PREFETCH_MAX_SLOTS];
+} prefetch_queue;
+
+/* Queues are created before prefetch_start and destroyed after prefetch_stop */
+int prefetch_queue_create(prefetch_queue* queue, uint32_t chunk_size, unsigned int slots);
+void prefetch_queue_destroy(prefetch_queue* queue);
+
+/* One worker serves every queue, read NULL uses DAT_read_file_by_num */
+int prefetch_start(prefetch_read_cb read);
+/* Waits for the read in flight, after this nothing touches the DATs behind the main thread */
+void prefetch_stop(void);
+int prefetch_running(void);
+
+/* Main thread only from here */
+
+/* Slot holding key once it is read, otherwise queues it ahead of any hint and returns -1 */
+int prefetch_fetch(prefetch_queue* queue, const struct dat_file* bin, uint32_t chunk_num, const char* key);
+/* Queues key to be read when nothing urgent is waiting, never displaces urgent slots */
+void prefetch_hint(prefetch_queue* queue, const struct dat_file* bin, uint32_t chunk_num, const char* key);
+/* Call before hinting a new page, what was urgent or hinted before is read after it */
+void prefetch_demote(prefetch_queue* queue);
+/* Hands a slot from prefetch_fetch back once uploaded */
+void prefetch_release(prefetch_queue* queue, int slot);
+
+static inline const void*
+prefetch_slot_data(const prefetch_queue* queue, int slot) {
+    return queue->buffers + (slot * queue->chunk_size);
+}
+
+static inline int
+prefetch_slot_ok(const prefetch_queue* queue, int slot) {
+    return queue->slot[slot].ok;
+}
@@ -18,7 +18,7 @@
 static unsigned char* _internal_buf = NULL;
 static char filename_safe[128];
 
-static uint32_t
+uint32_t
 pvr_get_texture_size(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrFormat) {
     unsigned char* texBuf = (unsigned char*)input;
 
@@ -85,7 +85,8 @@ pvr_get_texture_size(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrF
         default: texFormat = PVR_TXRFMT_NONE; break;
     }
 
-    const int txr_size = texW * texH * bpp;
+    /* VQ is a 2KB codebook then a byte per 2x2 block */
+    const int txr_size = (texFormat & PVR_TXRFMT_VQ_ENABLE) ? (2048 + (texW * texH) / 4) : (texW * texH * bpp);
     *w = texW;
     *h = texH;
     *txrFormat = texFormat | texColor;
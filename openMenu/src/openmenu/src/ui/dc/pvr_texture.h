@@ -21,6 +21,8 @@ typedef struct image {
 } image;
 
 void* pvr_get_internal_buffer(void);
+/* Bytes the texture in a .pvr buffer takes in VRAM, fills in its size and format */
+uint32_t pvr_get_texture_size(const void* input, uint32_t* w, uint32_t* h, uint32_t* txrFormat);
 /* Convenience functions */
 extern pvr_ptr_t load_pvr(const char* filename, uint32_t* w, uint32_t* h, uint32_t* txrFormat);
 extern pvr_ptr_t load_pvr_to_buffer(const char* filename, uint32_t* w, uint32_t* h, uint32_t* txrFormat, void* buffer);
@@ -157,6 +157,13 @@ draw_load_texture_from_DAT_to_buffer(const struct dat_file* bin, const char* ID,
     return user;
 }
 
+void*
+draw_load_texture_from_chunk_to_buffer(const void* chunk, void* user, void* buffer) {
+    image* img = (image*)user;
+    img->texture = load_pvr_from_buffer_to_buffer(chunk, &img->width, &img->height, &img->format, buffer);
+    return user;
+}
+
 /* draws an image at coords of a given size */
 void
 draw_draw_image(int x, int y, float width, float height, uint32_t color, void* user) {
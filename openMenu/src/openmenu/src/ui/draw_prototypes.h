@@ -45,6 +45,8 @@ void* draw_load_texture(const char* filename, void* user);
 void* draw_load_texture_buffer(const char* filename, void* user, void* buffer);
 /* Loads from new DAT file using struct + ID of file requested */
 void* draw_load_texture_from_DAT_to_buffer(const struct dat_file* bin, const char* ID, void* user, void* buffer);
+/* Same for a chunk already read from a DAT */
+void* draw_load_texture_from_chunk_to_buffer(const void* chunk, void* user, void* buffer);
 
 /* draws an image at coords of a given size */
 void draw_draw_image(int x, int y, float width, float height, uint32_t color, void* user);
@@ -22,6 +22,7 @@
 #include <backend/gd_list.h>
 #include <openmenu_settings.h>
 #include "dc/input.h"
+#include "texture/txr_binding.h"
 #include "texture/txr_manager.h"
 #include "ui/draw_prototypes.h"
 #include "ui/font_prototypes.h"
@@ -36,6 +37,7 @@
 /* Static resources */
 static image txr_bg_left, txr_bg_right;
 static image txr_focus;
+static txr_binding focus_binding; /* Which item txr_focus holds */
 extern image img_empty_boxart;
 extern image img_dir_boxart;
 
@@ -94,6 +96,7 @@ static int list_len;
 /* Navigation state */
 static int current_selected_item = 0;
 static int current_starting_index = 0;
+static int prefetched_item = -1; /* current_selected_item the last prefetch was for */
 static int navigate_timeout = INPUT_TIMEOUT_INITIAL;
 static enum draw_state draw_current = DRAW_UI;
 
@@ -373,6 +376,8 @@ draw_gameart(void) {
         return;
     }
 
+    txr_prefetch_large_around(list_current, list_len, current_selected_item, &prefetched_item);
+
     const gd_item* item = list_current[current_selected_item];
 
     /* Don't show artwork for folders */
@@ -381,10 +386,13 @@ draw_gameart(void) {
     }
 
     /* Load artwork for games */
-    {
-        txr_get_large(item->product, &txr_focus);
+    if (!txr_binding_hit(&focus_binding, current_selected_item)) {
+        int pending = txr_get_large_item(item, &txr_focus);
         if (txr_focus.texture == img_empty_boxart.texture) {
-            txr_get_small(item->product, &txr_focus);
+            pending |= txr_get_small_item(item, &txr_focus);
+        }
+        if (!pending) {
+            txr_binding_set(&focus_binding, current_selected_item);
         }
     }
 
@@ -910,8 +918,7 @@ handle_input_ui(enum control input) {
 
 FUNCTION(UI_NAME, init) {
     texman_clear();
-    txr_empty_small_pool();
-    txr_empty_large_pool();
+    txr_empty_pool();
 
     /* Load default FOLDERS theme from THEME.INI */
     theme_read("/cd/THEME/FOLDERS/THEME.INI", &default_theme, 2);
@@ -954,6 +961,8 @@ FUNCTION(UI_NAME, setup) {
     /* Reset navigation state */
     current_selected_item = 0;
     current_starting_index = 0;
+    prefetched_item = -1;
+    txr_binding_reset(&focus_binding);
     navigate_timeout = 3;
     draw_current = DRAW_UI;
 
@@ -16,6 +16,7 @@
 #include <backend/gd_item.h>
 #include <backend/gd_list.h>
 
+#include "texture/txr_binding.h"
 #include "texture/txr_manager.h"
 #include "ui/animation.h"
 #include "ui/draw_prototypes.h"
@@ -77,6 +78,7 @@ TILE_Y_POS(int row) {
 static int screen_row = 0;
 static int screen_column = 0;
 static int current_starting_index = 0;
+static int prefetched_index = -1; /* current_starting_index the last prefetch was for */
 static int navigate_timeout = INPUT_TIMEOUT;
 static int frames_focused = 0;
 
@@ -94,6 +96,7 @@ static anim2d anim_large_art_scale;
 
 /* For drawing */
 static image txr_icon_list[/*ROWS * COLUMNS*/ 4 * 3 /* Assume the worst */]; /* Lower list of 9 or 12 icons */
+static txr_binding icon_binding[/*ROWS * COLUMNS*/ 4 * 3]; /* Which item each of txr_icon_list holds */
 static image txr_focus;
 static image txr_highlight; /* Highlight square */
 static image txr_bg_left, txr_bg_right;
@@ -161,7 +164,7 @@ current_selected(void) {
 static void
 draw_large_art(void) {
     if (anim_active(&anim_large_art_scale.time)) {
-        txr_get_large(list_current[current_selected()]->product, &txr_focus);
+        txr_get_large_item(list_current[current_selected()], &txr_focus);
         if (txr_focus.texture == img_empty_boxart.texture
             || !strncmp(list_current[current_selected()]->disc, "DIR", 3)) {
             /* Only draw if large is present */
@@ -209,8 +212,34 @@ draw_animated_highlight(int width, int height) {
     z_set(z);
 }
 
+/* Reads ahead the page the grid is scrolling towards */
+static void
+prefetch_next_page(void) {
+    if (current_starting_index == prefetched_index) {
+        return;
+    }
+    const int page = ROWS * COLUMNS;
+    const int forward = (current_starting_index > prefetched_index);
+    const gd_item* items[/*ROWS * COLUMNS*/ 4 * 3];
+    int count = 0;
+    prefetched_index = current_starting_index;
+
+    for (int i = 0; i < page && count < (int)(sizeof(items) / sizeof(items[0])); i++) {
+        const int idx = forward ? (current_starting_index + page + i) : (current_starting_index - 1 - i);
+        if (idx < 0 || idx >= list_len) {
+            break;
+        }
+        if (!strncmp(list_current[idx]->disc, "DIR", 3) && !strncmp(list_current[idx]->name, "Back", 4)) {
+            continue;
+        }
+        items[count++] = list_current[idx];
+    }
+    txr_prefetch_small(items, count);
+}
+
 static void
 draw_grid_boxes(void) {
+    prefetch_next_page();
     for (int row = 0; row < ROWS; row++) {
         for (int column = 0; column < COLUMNS; column++) {
             int idx = (row * COLUMNS) + column;
@@ -232,8 +261,11 @@ draw_grid_boxes(void) {
                 txr_icon_list[idx].width = img_dir_boxart.width;
                 txr_icon_list[idx].height = img_dir_boxart.height;
                 txr_icon_list[idx].format = img_dir_boxart.format;
-            } else {
-                txr_get_small(list_current[current_starting_index + idx]->product, &txr_icon_list[idx]);
+                txr_binding_reset(&icon_binding[idx]);
+            } else if (!txr_binding_hit(&icon_binding[idx], current_starting_index + idx)) {
+                if (!txr_get_small_item(list_current[current_starting_index + idx], &txr_icon_list[idx])) {
+                    txr_binding_set(&icon_binding[idx], current_starting_index + idx);
+                }
             }
             draw_draw_image((int)x_pos, (int)y_pos, TILE_SIZE_X * X_SCALE, TILE_SIZE_Y, COLOR_WHITE,
                             &txr_icon_list[idx]);
@@ -522,6 +554,7 @@ menu_accept(void) {
 
         screen_column = screen_row = 0;
         current_starting_index = 0;
+        prefetched_index = -1;
         draw_current = DRAW_UI;
 
         navigate_timeout = 3;
@@ -607,12 +640,26 @@ menu_exit(void) {
     exit_menu_setup(&draw_current, current_theme_colors, &navigate_timeout, current_theme_colors->menu_highlight_color, 0 /* not a folder */);
 }
 
+/* Shows the search results as they refine, from the top */
+static void
+menu_search_results(void) {
+    list_current = list_get();
+    list_len = list_length();
+
+    screen_column = screen_row = 0;
+    current_starting_index = 0;
+    prefetched_index = -1;
+
+    anim_clear(&anim_highlight);
+    anim_clear(&anim_large_art_pos);
+    anim_clear(&anim_large_art_scale);
+}
+
 /* Base UI Methods */
 
 FUNCTION(UI_NAME, init) {
     texman_clear();
-    txr_empty_small_pool();
-    txr_empty_large_pool();
+    txr_empty_pool();
     /* Set region from preferences */
     region_current = sf_region[0];
     recalculate_aspect(sf_aspect[0]);
@@ -741,6 +788,8 @@ FUNCTION(UI_NAME, setup) {
 
     screen_column = screen_row = 0;
     current_starting_index = 0;
+    prefetched_index = -1;
+    memset(icon_binding, 0, sizeof(icon_binding));
     draw_current = DRAW_UI;
 
     navigate_timeout = 3;
@@ -781,6 +830,11 @@ FUNCTION_INPUT(UI_NAME, handle_input) {
         case DRAW_DCNOW_PLAYERS: {
             handle_input_dcnow(input_current);
         } break;
+        case DRAW_SEARCH: {
+            if (handle_input_search(input_current)) {
+                menu_search_results();
+            }
+        } break;
         default:
         case DRAW_UI: {
             handle_input_ui(input_current);
@@ -826,6 +880,10 @@ FUNCTION(UI_NAME, drawOP) {
             /* DC Now popup on top */
             draw_dcnow_op();
         } break;
+        case DRAW_SEARCH: {
+            /* Search popup on top */
+            draw_search_op();
+        } break;
         default:
         case DRAW_UI: {
             /* always drawn */
@@ -873,6 +931,10 @@ FUNCTION(UI_NAME, drawTR) {
             /* DC Now popup on top */
             draw_dcnow_tr();
         } break;
+        case DRAW_SEARCH: {
+            /* Search popup on top */
+            draw_search_tr();
+        } break;
         default:
         case DRAW_UI: {
             /* always drawn */
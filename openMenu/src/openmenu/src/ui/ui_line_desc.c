@@ -18,6 +18,7 @@
 #include <backend/gd_item.h>
 #include <backend/gd_list.h>
 
+#include "texture/txr_binding.h"
 #include "texture/txr_manager.h"
 #include "ui/draw_prototypes.h"
 #include "ui/font_prototypes.h"
@@ -59,6 +60,7 @@ db_item* current_meta;
 
 /* For drawing */
 static image txr_icon_list[16]; /* Lower list of 9 icons */
+static txr_binding icon_binding[16]; /* Which item each of txr_icon_list holds */
 static image txr_focus;         /* current selected item, either lowres or hires */
 static image txr_highlight;     /* Highlight square*/
 static image txr_bg_left, txr_bg_right;
@@ -154,8 +156,11 @@ draw_small_boxes(void) {
             txr_icon_list[i].width = img_dir_boxart.width;
             txr_icon_list[i].height = img_dir_boxart.height;
             txr_icon_list[i].format = img_dir_boxart.format;
-        } else {
-            txr_get_small(list_current[starting_icon_idx + i]->product, &txr_icon_list[i]);
+            txr_binding_reset(&icon_binding[i]);
+        } else if (!txr_binding_hit(&icon_binding[i], starting_icon_idx + i)) {
+            if (!txr_get_small_item(list_current[starting_icon_idx + i], &txr_icon_list[i])) {
+                txr_binding_set(&icon_binding[i], starting_icon_idx + i);
+            }
         }
         draw_draw_image((x_start + (ICON_SIZE_X + ICON_SPACING) * i) * X_SCALE, y_pos, ICON_SIZE_X * X_SCALE,
                         ICON_SIZE_Y, COLOR_WHITE, &txr_icon_list[i]);
@@ -286,7 +291,7 @@ draw_game_meta(void) {
 static void
 menu_changed_item(void) {
     frames_focused = 0;
-    db_get_meta(list_current[current_selected_item]->product, &current_meta);
+    db_get_meta(gd_item_meta_id(list_current[current_selected_item]), &current_meta);
 }
 
 static bool
@@ -525,12 +530,12 @@ update_data(void) {
         txr_focus.format = img_dir_boxart.format;
     } else {
         if (frames_focused > FOCUSED_HIRES_FRAMES) {
-            txr_get_large(list_current[current_selected_item]->product, &txr_focus);
+            txr_get_large_item(list_current[current_selected_item], &txr_focus);
             if (txr_focus.texture == img_empty_boxart.texture) {
-                txr_get_small(list_current[current_selected_item]->product, &txr_focus);
+                txr_get_small_item(list_current[current_selected_item], &txr_focus);
             }
         } else {
-            txr_get_small(list_current[current_selected_item]->product, &txr_focus);
+            txr_get_small_item(list_current[current_selected_item], &txr_focus);
         }
     }
 
@@ -548,12 +553,22 @@ menu_exit(void) {
     exit_menu_setup(&draw_current, &region_themes[region_current].colors, &navigate_timeout, region_themes[region_current].colors.menu_highlight_color, 0 /* not a folder */);
 }
 
+/* Shows the search results as they refine, from the top */
+static void
+menu_search_results(void) {
+    list_current = list_get();
+    list_len = list_length();
+
+    current_selected_item = 0;
+    frames_focused = 0;
+    menu_changed_item();
+}
+
 /* Base UI Methods */
 
 FUNCTION(UI_NAME, init) {
     texman_clear();
-    txr_empty_small_pool();
-    txr_empty_large_pool();
+    txr_empty_pool();
     /* Set region from preferences */
     region_current = sf_region[0];
     recalculate_aspect(sf_aspect[0]);
@@ -661,6 +676,7 @@ FUNCTION(UI_NAME, setup) {
 
     current_selected_item = 0;
     frames_focused = 0;
+    memset(icon_binding, 0, sizeof(icon_binding));
     draw_current = DRAW_UI;
 
     navigate_timeout = INPUT_TIMEOUT * 2;
@@ -697,6 +713,11 @@ FUNCTION_INPUT(UI_NAME, handle_input) {
         case DRAW_DCNOW_PLAYERS: {
             handle_input_dcnow(input_current);
         } break;
+        case DRAW_SEARCH: {
+            if (handle_input_search(input_current)) {
+                menu_search_results();
+            }
+        } break;
         default:
         case DRAW_UI: {
             handle_input_ui(input_current);
@@ -742,6 +763,10 @@ FUNCTION(UI_NAME, drawOP) {
             /* DC Now popup on top */
             draw_dcnow_op();
         } break;
+        case DRAW_SEARCH: {
+            /* Search popup on top */
+            draw_search_op();
+        } break;
         default:
         case DRAW_UI: {
             /* always drawn */
@@ -790,6 +815,10 @@ FUNCTION(UI_NAME, drawTR) {
             /* DC Now popup on top */
             draw_dcnow_tr();
         } break;
+        case DRAW_SEARCH: {
+            /* Search popup on top */
+            draw_search_tr();
+        } break;
         default:
         case DRAW_UI: {
             /* always drawn */
@@ -18,6 +18,7 @@
 #include <crayon_savefile/savefile.h>
 #include <openmenu_savefile.h>
 #include <openmenu_settings.h>
+#include <texture/serial_sanitize.h>
 
 #include "ui/draw_kos.h"
 #include "ui/draw_prototypes.h"
@@ -32,6 +33,7 @@
 
 /* External declaration for VM2/VMUPro/USB4Maple detection */
 #include <dc/maple.h>
+#include <dc/maple/keyboard.h>
 #include "vm2/vm2_api.h"
 extern int vm2_device_count;
 extern void vm2_rescan(void);
@@ -144,6 +146,7 @@ static const char* boot_mode_choice_text[] = {"Full Boot", "License Only", "Anim
 static const char* dcnow_vmu_choice_text[] = {"On", "Off"};
 static const char* save_choice_text[] = {"Save/Load", "Apply"};
 static const char* credits_text[] = {"Credits"};
+static const char* search_text[] = {"Search"};
 
 const char* custom_theme_text[10] = {0};
 static theme_custom* custom_themes;
@@ -198,6 +201,7 @@ typedef enum MENU_CHOICE {
     CHOICE_BOOT_MODE,
     CHOICE_DCNOW_VMU,
     CHOICE_SAVE,
+    CHOICE_SEARCH,
     CHOICE_DCNOW,
     CHOICE_CREDITS,
     CHOICE_END = CHOICE_CREDITS
@@ -269,6 +273,23 @@ get_cur_game_item() {
     return cur_game_item;
 }
 
+/* Back to the saved sort or filter, after a load or a cleared search */
+static void
+apply_saved_sort(void) {
+    if (!sf_filter[0]) {
+        switch ((CFG_SORT)sf_sort[0]) {
+            case SORT_NAME: list_set_sort_name(); break;
+            case SORT_DATE: list_set_sort_region(); break;
+            case SORT_PRODUCT: list_set_sort_genre(); break;
+            case SORT_SD_CARD: list_set_sort_default(); break;
+            default:
+            case SORT_DEFAULT: list_set_sort_alphabetical(); break;
+        }
+    } else {
+        list_set_genre_sort((FLAGS_GENRE)sf_filter[0] - 1, sf_sort[0]);
+    }
+}
+
 static void
 common_setup(enum draw_state* state, theme_color* _colors, int* timeout_ptr) {
     /* Ensure color themeing is consistent */
@@ -480,6 +501,9 @@ menu_accept(void) {
         extern void reload_ui(void);
         reload_ui();
     }
+    if (current_choice == CHOICE_SEARCH) {
+        search_setup(state_ptr, stored_colors, input_timeout_ptr, menu_title_color);
+    }
     if (current_choice == CHOICE_DCNOW) {
         /* Call dcnow_setup() to initialize the DC Now popup */
         dcnow_setup(state_ptr, stored_colors, input_timeout_ptr, menu_title_color);
@@ -552,8 +576,8 @@ menu_choice_prev(void) {
         if (current_choice == CHOICE_BEEP) {
             skip = 1;
         }
-        /* Skip DCNOW in up/down navigation (reached via left/right from Save/Apply) */
-        if (current_choice == CHOICE_DCNOW) {
+        /* Skip SEARCH and DCNOW in up/down navigation (reached via left/right from Save/Apply) */
+        if (current_choice == CHOICE_SEARCH || current_choice == CHOICE_DCNOW) {
             skip = 1;
         }
         /* Skip CREDITS in up/down navigation (reached via left/right from Save/Apply) */
@@ -634,8 +658,8 @@ menu_choice_next(void) {
         if (current_choice == CHOICE_BEEP) {
             skip = 1;
         }
-        /* Skip DCNOW in up/down navigation (reached via left/right from Save/Apply) */
-        if (current_choice == CHOICE_DCNOW) {
+        /* Skip SEARCH and DCNOW in up/down navigation (reached via left/right from Save/Apply) */
+        if (current_choice == CHOICE_SEARCH || current_choice == CHOICE_DCNOW) {
             skip = 1;
         }
         /* Skip CREDITS in up/down navigation (reached via left/right from Save/Apply) */
@@ -702,15 +726,21 @@ menu_choice_left(void) {
     if (*input_timeout_ptr > 0) {
         return;
     }
-    /* Handle Save/Apply/DC Now/Credits row navigation */
+    /* Handle Save/Apply/Search/DC Now/Credits row navigation */
     if (current_choice == CHOICE_CREDITS) {
         /* Move left from Credits to DC Now */
         current_choice = CHOICE_DCNOW;
         *input_timeout_ptr = INPUT_TIMEOUT;
         return;
     }
-    if (current_choice == CHOICE_DCNOW) {
-        /* Move left from DC Now to Apply */
+    if (current_choice == CHOICE_DCNOW && sf_ui[0] != UI_FOLDERS) {
+        /* Move left from DC Now to Search, Folders has no Search */
+        current_choice = CHOICE_SEARCH;
+        *input_timeout_ptr = INPUT_TIMEOUT;
+        return;
+    }
+    if (current_choice == CHOICE_DCNOW || current_choice == CHOICE_SEARCH) {
+        /* Move left to Apply */
         current_choice = CHOICE_SAVE;
         choices[CHOICE_SAVE] = 1;  /* Select Apply */
         *input_timeout_ptr = INPUT_TIMEOUT;
@@ -735,7 +765,7 @@ menu_choice_right(void) {
     if (*input_timeout_ptr > 0) {
         return;
     }
-    /* Handle Save/Apply/DC Now/Credits row navigation */
+    /* Handle Save/Apply/Search/DC Now/Credits row navigation */
     if (current_choice == CHOICE_CREDITS) {
         /* Already on Credits (rightmost), do nothing */
         return;
@@ -746,12 +776,18 @@ menu_choice_right(void) {
         *input_timeout_ptr = INPUT_TIMEOUT;
         return;
     }
-    if (current_choice == CHOICE_SAVE && choices[CHOICE_SAVE] == 1) {
-        /* On Apply, move right to DC Now */
+    if (current_choice == CHOICE_SEARCH) {
+        /* Move right from Search to DC Now */
         current_choice = CHOICE_DCNOW;
         *input_timeout_ptr = INPUT_TIMEOUT;
         return;
     }
+    if (current_choice == CHOICE_SAVE && choices[CHOICE_SAVE] == 1) {
+        /* On Apply, move right to Search, or DC Now in Folders which has no Search */
+        current_choice = (sf_ui[0] != UI_FOLDERS) ? CHOICE_SEARCH : CHOICE_DCNOW;
+        *input_timeout_ptr = INPUT_TIMEOUT;
+        return;
+    }
     choices[current_choice]++;
     /* In Folders mode, limit Sort to 2 options */
     int max_choice = choices_max[current_choice];
@@ -1131,21 +1167,32 @@ draw_menu_tr(void) {
             font_bmp_draw_main(x_item, cur_y, line_buf);
         }
 
-        /* Draw Save/Apply/DC Now/Credits on one line */
+        /* Draw Save/Apply/Search/DC Now/Credits on one line */
         uint32_t save_color =
             ((current_choice == CHOICE_SAVE) && (choices[CHOICE_SAVE] == 0) ? highlight_color : text_color);
         uint32_t apply_color =
             ((current_choice == CHOICE_SAVE) && (choices[CHOICE_SAVE] == 1) ? highlight_color : text_color);
+        uint32_t search_color = (current_choice == CHOICE_SEARCH ? highlight_color : text_color);
         uint32_t dcnow_color = (current_choice == CHOICE_DCNOW ? highlight_color : text_color);
         uint32_t credits_color = (current_choice == CHOICE_CREDITS ? highlight_color : text_color);
         cur_y += line_height;
-        /* Save, Apply, DC NOW!, Credits across the bottom */
-        font_bmp_set_color(save_color);
-        font_bmp_draw_main(640 / 2 - (8 * 18), cur_y, save_choice_text[0]);
-        font_bmp_set_color(apply_color);
-        font_bmp_draw_main(640 / 2 - (8 * 7), cur_y, save_choice_text[1]);
+        if (sf_ui[0] == UI_FOLDERS) {
+            /* Save, Apply, DC NOW!, Credits across the bottom */
+            font_bmp_set_color(save_color);
+            font_bmp_draw_main(640 / 2 - (8 * 18), cur_y, save_choice_text[0]);
+            font_bmp_set_color(apply_color);
+            font_bmp_draw_main(640 / 2 - (8 * 7), cur_y, save_choice_text[1]);
+        } else {
+            /* Save, Apply, Search, DC NOW!, Credits across the bottom */
+            font_bmp_set_color(save_color);
+            font_bmp_draw_main(640 / 2 - (8 * 18), cur_y, save_choice_text[0]);
+            font_bmp_set_color(apply_color);
+            font_bmp_draw_main(640 / 2 - (8 * 12), cur_y, save_choice_text[1]);
+            font_bmp_set_color(search_color);
+            font_bmp_draw_main(640 / 2 - (8 * 5), cur_y, search_text[0]);
+        }
         font_bmp_set_color(dcnow_color);
-        font_bmp_draw_main(640 / 2 + (8 * 1), cur_y, "DC NOW!");
+        font_bmp_draw_main(640 / 2 + (8 * ((sf_ui[0] == UI_FOLDERS) ? 1 : 3)), cur_y, "DC NOW!");
         font_bmp_set_color(credits_color);
         font_bmp_draw_main(640 / 2 + (8 * 11), cur_y, credits_text[0]);
 
@@ -1262,18 +1309,22 @@ draw_menu_tr(void) {
             }
         }
 
-        /* Draw Save/Apply/DC Now/Credits on one line */
+        /* Draw Save/Apply/Search/DC Now/Credits on one line */
         uint32_t save_color =
             ((current_choice == CHOICE_SAVE) && (choices[CHOICE_SAVE] == 0) ? highlight_color : text_color);
         uint32_t apply_color =
             ((current_choice == CHOICE_SAVE) && (choices[CHOICE_SAVE] == 1) ? highlight_color : text_color);
+        uint32_t search_color = ((current_choice == CHOICE_SEARCH) ? highlight_color : text_color);
         uint32_t dcnow_color = ((current_choice == CHOICE_DCNOW) ? highlight_color : text_color);
         uint32_t credits_color = ((current_choice == CHOICE_CREDITS) ? highlight_color : text_color);
+        /* Five evenly spaced from 50 in at either edge */
+        const int step = (width - 100) / 4;
         cur_y += line_height;
-        font_bmf_draw_centered(640 / 2 - (width / 2) + 50, cur_y, save_color, save_choice_text[0]);
-        font_bmf_draw_centered(640 / 2 - (width / 6), cur_y, apply_color, save_choice_text[1]);
-        font_bmf_draw_centered(640 / 2 + (width / 6), cur_y, dcnow_color, "DC NOW!");
-        font_bmf_draw_centered(640 / 2 + (width / 2) - 50, cur_y, credits_color, credits_text[0]);
+        font_bmf_draw_centered(640 / 2 - (2 * step), cur_y, save_color, save_choice_text[0]);
+        font_bmf_draw_centered(640 / 2 - step, cur_y, apply_color, save_choice_text[1]);
+        font_bmf_draw_centered(640 / 2, cur_y, search_color, search_text[0]);
+        font_bmf_draw_centered(640 / 2 + step, cur_y, dcnow_color, "DC NOW!");
+        font_bmf_draw_centered(640 / 2 + (2 * step), cur_y, credits_color, credits_text[0]);
 
         /* Add empty line for spacing */
         cur_y += line_height;
@@ -2106,18 +2157,7 @@ static void saveload_do_load(void) {
 static void saveload_close_all(int do_reload) {
     if (do_reload) {
         /* Apply loaded settings to sort/filter */
-        if (!sf_filter[0]) {
-            switch ((CFG_SORT)sf_sort[0]) {
-                case SORT_NAME: list_set_sort_name(); break;
-                case SORT_DATE: list_set_sort_region(); break;
-                case SORT_PRODUCT: list_set_sort_genre(); break;
-                case SORT_SD_CARD: list_set_sort_default(); break;
-                default:
-                case SORT_DEFAULT: list_set_sort_alphabetical(); break;
-            }
-        } else {
-            list_set_genre_sort((FLAGS_GENRE)sf_filter[0] - 1, sf_sort[0]);
-        }
+        apply_saved_sort();
 
         extern void reload_ui(void);
         reload_ui();
@@ -2833,6 +2873,299 @@ draw_saveload_tr(void) {
 
 #pragma endregion SaveLoad_Menu
 
+#pragma region Search_Menu
+
+/* On-screen keyboard, SEARCH_COLUMNS chars a row, then the action row */
+#define SEARCH_COLUMNS     (10)
+#define SEARCH_QUERY_MAX   (24)
+#define SEARCH_NO_MATCH    (45) /* Frames "No match" stays up after a dropped key */
+static const char search_keys[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-:'!";
+#define SEARCH_CHAR_ROWS   ((int)(sizeof(search_keys) - 1) / SEARCH_COLUMNS)
+static const char* search_action_text[] = {"Space", "Del", "Done"};
+#define SEARCH_NUM_ACTIONS ((int)(sizeof(search_action_text) / sizeof(search_action_text)[0]))
+
+typedef enum SEARCH_ACTION { SEARCH_ACTION_SPACE = 0, SEARCH_ACTION_DEL, SEARCH_ACTION_DONE } SEARCH_ACTION;
+
+static char search_query[SEARCH_QUERY_MAX];
+static int search_len = 0;
+static int search_row = 0; /* SEARCH_CHAR_ROWS is the action row */
+static int search_col = 0;
+static int search_no_match = 0;
+static unsigned int search_gen = 0; /* list_generation() when the results were left on screen */
+
+void
+search_setup(enum draw_state* state, theme_color* _colors, int* timeout_ptr, uint32_t title_color) {
+    common_setup(state, _colors, timeout_ptr);
+    menu_title_color = title_color;
+
+    /* Carry on from the last query only while its results are still what the UI shows */
+    if (list_generation() != search_gen) {
+        search_len = 0;
+        search_query[0] = '\0';
+    }
+    search_row = search_col = 0;
+    search_no_match = 0;
+    list_search_prepare();
+    *state_ptr = DRAW_SEARCH;
+}
+
+/* Lists the games matching search_query, or the saved sort once it is empty */
+static void
+search_apply(void) {
+    if (search_len) {
+        list_set_search(search_query);
+    } else {
+        apply_saved_sort();
+    }
+}
+
+/* Returns 1 when the list changed */
+static int
+search_type(char c) {
+    if (search_len >= SEARCH_QUERY_MAX - 1 || (c == ' ' && (!search_len || search_query[search_len - 1] == ' '))) {
+        return 0;
+    }
+    search_query[search_len] = c;
+    search_query[search_len + 1] = '\0';
+    if (list_set_search(search_query)) {
+        search_len++;
+        return 1;
+    }
+    /* Nothing has this in its name, keep the last results rather than an empty list */
+    search_query[search_len] = '\0';
+    if (!search_len || list_search_restore(search_query) < 0) {
+        search_apply();
+    }
+    search_no_match = SEARCH_NO_MATCH;
+    return 1;
+}
+
+static int
+search_delete(void) {
+    if (!search_len) {
+        return 0;
+    }
+    search_query[--search_len] = '\0';
+    search_apply();
+    return 1;
+}
+
+static void
+search_leave(void) {
+    search_gen = list_generation();
+    *state_ptr = DRAW_UI;
+    *input_timeout_ptr = (30 * 1) /* half a second */;
+}
+
+/* Letters on a Dreamcast keyboard also stand in for buttons in translate_input,
+ * so while any typing key is down the button it maps to is ignored */
+static int
+search_keyboard(int* changed) {
+    int held = 0;
+    for (int i = 0; i < 26; i++) {
+        if (INPT_KeyboardButton(KBD_KEY_A + i)) {
+            held = 1;
+            if (INPT_KeyboardButtonPress(KBD_KEY_A + i)) {
+                *changed |= search_type('A' + i);
+            }
+        }
+    }
+    /* KBD_KEY_1 through KBD_KEY_9 then KBD_KEY_0 */
+    for (int i = 0; i < 10; i++) {
+        if (INPT_KeyboardButtonPress(KBD_KEY_1 + i)) {
+            *changed |= search_type((i == 9) ? '0' : '1' + i);
+        }
+    }
+    if (INPT_KeyboardButton(KBD_KEY_SPACE)) {
+        held = 1;
+        if (INPT_KeyboardButtonPress(KBD_KEY_SPACE)) {
+            *changed |= search_type(' ');
+        }
+    }
+    if (INPT_KeyboardButtonPress(KBD_KEY_MINUS)) {
+        *changed |= search_type('-');
+    }
+    if (INPT_KeyboardButtonPress(KBD_KEY_BACKSPACE)) {
+        *changed |= search_delete();
+    }
+    return held;
+}
+
+static void
+search_move(int rows, int cols) {
+    if (*input_timeout_ptr > 0) {
+        return;
+    }
+    if (rows > 0 && search_row == SEARCH_CHAR_ROWS - 1) {
+        search_col = search_col * SEARCH_NUM_ACTIONS / SEARCH_COLUMNS;
+    } else if (rows < 0 && search_row == SEARCH_CHAR_ROWS) {
+        search_col = (search_col * SEARCH_COLUMNS / SEARCH_NUM_ACTIONS) + 1;
+    }
+    search_row += rows;
+    if (search_row < 0) {
+        search_row = 0;
+    }
+    if (search_row > SEARCH_CHAR_ROWS) {
+        search_row = SEARCH_CHAR_ROWS;
+    }
+
+    const int row_len = (search_row == SEARCH_CHAR_ROWS) ? SEARCH_NUM_ACTIONS : SEARCH_COLUMNS;
+    search_col += cols;
+    if (search_col < 0) {
+        search_col = 0;
+    }
+    if (search_col >= row_len) {
+        search_col = row_len - 1;
+    }
+    *input_timeout_ptr = INPUT_TIMEOUT;
+}
+
+static int
+search_press(void) {
+    if (search_row < SEARCH_CHAR_ROWS) {
+        return search_type(search_keys[(search_row * SEARCH_COLUMNS) + search_col]);
+    }
+    switch ((SEARCH_ACTION)search_col) {
+        case SEARCH_ACTION_SPACE: return search_type(' ');
+        case SEARCH_ACTION_DEL: return search_delete();
+        default:
+        case SEARCH_ACTION_DONE: search_leave(); break;
+    }
+    return 0;
+}
+
+int
+handle_input_search(enum control input) {
+    int changed = 0;
+    if (search_no_match > 0) {
+        search_no_match--;
+    }
+    if (search_keyboard(&changed)) {
+        return changed;
+    }
+
+    switch (input) {
+        case LEFT: search_move(0, -1); break;
+        case RIGHT: search_move(0, 1); break;
+        case UP: search_move(-1, 0); break;
+        case DOWN: search_move(1, 0); break;
+        case A: changed = search_press(); break;
+        case B:
+            /* Deletes a char, closes once there is nothing left to delete */
+            if (!search_delete()) {
+                search_leave();
+            } else {
+                changed = 1;
+            }
+            break;
+        case Y:
+            if (search_len) {
+                search_len = 0;
+                search_query[0] = '\0';
+                search_apply();
+                changed = 1;
+            }
+            break;
+        case START: search_leave(); break;
+        default: break;
+    }
+    return changed;
+}
+
+void
+draw_search_op(void) { /* Nothing needed */ }
+
+void
+draw_search_tr(void) {
+    z_set_cond(205.0f);
+
+    char query_str[SEARCH_QUERY_MAX + 1];
+    char count_str[24];
+    snprintf(query_str, sizeof(query_str), "%s_", search_query);
+    if (search_no_match) {
+        snprintf(count_str, sizeof(count_str), "No match");
+    } else {
+        snprintf(count_str, sizeof(count_str), "%d games", list_length());
+    }
+
+    if (sf_ui[0] == UI_SCROLL || sf_ui[0] == UI_FOLDERS) {
+        const int line_height = 24;
+        const int key_width = 24;
+        const int width = (SEARCH_COLUMNS * key_width) + 16;
+        const int height = (SEARCH_CHAR_ROWS + 3) * line_height + (line_height / 2);
+        const int x = (640 / 2) - (width / 2);
+        const int y = (480 / 2) - (height / 2);
+        const int x_item = x + 8;
+
+        draw_popup_menu(x, y, width, height);
+
+        int cur_y = y + 2;
+        font_bmp_begin_draw();
+        font_bmp_set_color(menu_title_color);
+        font_bmp_draw_main(x + width / 2 - (6 * 8 / 2), cur_y, "Search");
+
+        cur_y += line_height;
+        font_bmp_set_color(text_color);
+        font_bmp_draw_main(x_item, cur_y, query_str);
+        font_bmp_draw_main(x + width - 8 - ((int)strlen(count_str) * 8), cur_y, count_str);
+
+        char key_str[2] = {'\0', '\0'};
+        for (int row = 0; row < SEARCH_CHAR_ROWS; row++) {
+            cur_y += line_height;
+            for (int col = 0; col < SEARCH_COLUMNS; col++) {
+                key_str[0] = search_keys[(row * SEARCH_COLUMNS) + col];
+                font_bmp_set_color((row == search_row && col == search_col) ? highlight_color : text_color);
+                font_bmp_draw_main(x_item + (col * key_width) + (key_width / 2) - 4, cur_y, key_str);
+            }
+        }
+
+        cur_y += line_height;
+        for (int i = 0; i < SEARCH_NUM_ACTIONS; i++) {
+            const int center = x + (width * ((2 * i) + 1) / (2 * SEARCH_NUM_ACTIONS));
+            font_bmp_set_color((search_row == SEARCH_CHAR_ROWS && search_col == i) ? highlight_color : text_color);
+            font_bmp_draw_main(center - ((int)strlen(search_action_text[i]) * 8 / 2), cur_y, search_action_text[i]);
+        }
+    } else {
+        const int line_height = 32;
+        const int key_width = 36;
+        const int width = (SEARCH_COLUMNS * key_width) + 40;
+        const int height = (SEARCH_CHAR_ROWS + 3) * line_height + (line_height / 2);
+        const int x = (640 / 2) - (width / 2);
+        const int y = (480 / 2) - (height / 2);
+        const int x_item = x + 20;
+
+        draw_popup_menu(x, y, width, height);
+
+        int cur_y = y + 2;
+        font_bmf_begin_draw();
+        font_bmf_set_height_default();
+        font_bmf_draw_centered(x + width / 2, cur_y, text_color, "Search");
+
+        cur_y += line_height;
+        font_bmf_draw_auto_size(x_item, cur_y, highlight_color, query_str, width / 2);
+        font_bmf_draw_centered(x + width - 80, cur_y, text_color, count_str);
+
+        char key_str[2] = {'\0', '\0'};
+        for (int row = 0; row < SEARCH_CHAR_ROWS; row++) {
+            cur_y += line_height;
+            for (int col = 0; col < SEARCH_COLUMNS; col++) {
+                key_str[0] = search_keys[(row * SEARCH_COLUMNS) + col];
+                const uint32_t temp_color = (row == search_row && col == search_col) ? highlight_color : text_color;
+                font_bmf_draw_centered(x_item + (col * key_width) + (key_width / 2), cur_y, temp_color, key_str);
+            }
+        }
+
+        cur_y += line_height;
+        for (int i = 0; i < SEARCH_NUM_ACTIONS; i++) {
+            const int center = x + (width * ((2 * i) + 1) / (2 * SEARCH_NUM_ACTIONS));
+            const uint32_t temp_color = (search_row == SEARCH_CHAR_ROWS && search_col == i) ? highlight_color : text_color;
+            font_bmf_draw_centered(center, cur_y, temp_color, search_action_text[i]);
+        }
+    }
+}
+
+#pragma endregion Search_Menu
+
 /*
  * DC Now (dreamcast.online/now) Player Status Popup
  */
@@ -3593,7 +3926,7 @@ draw_dcnow_tr(void) {
                         printf("DC Now UI: API code '%s' -> product ID '%s'\n",
                                dcnow_data.games[game_idx].game_code, product_id);
 
-                        if (product_id && txr_get_small(product_id, &game_icon) == 0) {
+                        if (product_id && txr_get_small(serial_santize_art(product_id), &game_icon) == 0) {
                             /* Check if we got a real texture or just the empty placeholder */
                             if (game_icon.texture != img_empty_boxart.texture) {
                                 has_icon = true;
@@ -3978,7 +4311,7 @@ draw_dcnow_tr(void) {
                         /* Map API code to product ID */
                         const char* product_id = get_product_id_from_api_code(dcnow_data.games[game_idx].game_code);
 
-                        if (product_id && txr_get_small(product_id, &game_icon) == 0) {
+                        if (product_id && txr_get_small(serial_santize_art(product_id), &game_icon) == 0) {
                             /* Check if we got a real texture or just the empty placeholder */
                             if (game_icon.texture != img_empty_boxart.texture) {
                                 has_icon = true;
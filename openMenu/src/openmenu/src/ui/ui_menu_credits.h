@@ -57,5 +57,12 @@ void draw_dcnow_op(void);
 void draw_dcnow_tr(void);
 void dcnow_background_tick(void);
 
+/* Type-ahead search over the game list, handle_input_search returns 1 whenever
+ * list_get changed so the UI can pick up the new list */
+void search_setup(enum draw_state* state, struct theme_color* _colors, int* timeout_ptr, uint32_t title_color);
+int handle_input_search(enum control input);
+void draw_search_op(void);
+void draw_search_tr(void);
+
 void set_cur_game_item(const gd_item* id);
 const gd_item* get_cur_game_item();
@@ -17,6 +17,7 @@
 #include <backend/gd_item.h>
 #include <backend/gd_list.h>
 #include <openmenu_settings.h>
+#include "texture/txr_binding.h"
 #include "texture/txr_manager.h"
 #include "ui/draw_prototypes.h"
 #include "ui/font_prototypes.h"
@@ -174,6 +175,7 @@ get_marquee_speed_frames(void) {
 };*/
 
 static image txr_focus;
+static txr_binding focus_binding; /* Which item txr_focus holds */
 extern image img_empty_boxart;
 extern image img_dir_boxart;
 
@@ -182,6 +184,7 @@ extern image img_dir_boxart;
 
 static int current_selected_item = 0;
 static int current_starting_index = 0;
+static int prefetched_item = -1; /* current_selected_item the last prefetch was for */
 static int navigate_timeout = INPUT_TIMEOUT_INITIAL;
 static enum draw_state draw_current = DRAW_UI;
 
@@ -435,16 +438,22 @@ draw_gameart(void) {
         return;
     }
 
+    txr_prefetch_large_around(list_current, list_len, current_selected_item, &prefetched_item);
+
     if (!strncmp(list_current[current_selected_item]->disc, "DIR", 3)
         && !strncmp(list_current[current_selected_item]->name, "Back", 4)) {
         txr_focus.texture = img_dir_boxart.texture;
         txr_focus.width = img_dir_boxart.width;
         txr_focus.height = img_dir_boxart.height;
         txr_focus.format = img_dir_boxart.format;
-    } else {
-        txr_get_large(list_current[current_selected_item]->product, &txr_focus);
+        txr_binding_reset(&focus_binding);
+    } else if (!txr_binding_hit(&focus_binding, current_selected_item)) {
+        int pending = txr_get_large_item(list_current[current_selected_item], &txr_focus);
         if (txr_focus.texture == img_empty_boxart.texture) {
-            txr_get_small(list_current[current_selected_item]->product, &txr_focus);
+            pending |= txr_get_small_item(list_current[current_selected_item], &txr_focus);
+        }
+        if (!pending) {
+            txr_binding_set(&focus_binding, current_selected_item);
         }
     }
 
@@ -614,12 +623,24 @@ menu_exit(void) {
     exit_menu_setup(&draw_current, &cur_theme->colors, &navigate_timeout, cur_theme->colors.text_color, 0 /* not a folder */);
 }
 
+/* Shows the search results as they refine, from the top */
+static void
+menu_search_results(void) {
+    list_current = list_get();
+    list_len = list_length();
+
+    current_selected_item = 0;
+    current_starting_index = 0;
+    prefetched_item = -1;
+    marquee_reset();
+    marquee_last_selected = -1;
+}
+
 FUNCTION(UI_NAME, init) {
     texman_clear();
     /* @Note: these exist but do we really care? Naturally this will happen
    * without forcing it and old data doesn't matter */
-    txr_empty_small_pool();
-    txr_empty_large_pool();
+    txr_empty_pool();
     if (sf_custom_theme[0]) {
         int custom_theme_num = 0;
         custom = theme_get_scroll(&custom_theme_num);
@@ -709,6 +730,8 @@ FUNCTION(UI_NAME, setup) {
     current_selected_item = 0;
     current_starting_index = 0;
     navigate_timeout = INPUT_TIMEOUT_INITIAL * 2;
+    prefetched_item = -1;
+    txr_binding_reset(&focus_binding);
     draw_current = DRAW_UI;
 
     /* Initialize marquee state */
@@ -746,6 +769,11 @@ FUNCTION_INPUT(UI_NAME, handle_input) {
         case DRAW_DCNOW_PLAYERS: {
             handle_input_dcnow(input_current);
         } break;
+        case DRAW_SEARCH: {
+            if (handle_input_search(input_current)) {
+                menu_search_results();
+            }
+        } break;
         default:
         case DRAW_UI: {
             handle_input_ui(input_current);
@@ -790,6 +818,10 @@ FUNCTION(UI_NAME, drawOP) {
             /* DC Now popup on top */
             draw_dcnow_op();
         } break;
+        case DRAW_SEARCH: {
+            /* Search popup on top */
+            draw_search_op();
+        } break;
         default:
         case DRAW_UI: {
             /* always drawn */
@@ -835,6 +867,10 @@ FUNCTION(UI_NAME, drawTR) {
             /* DC Now popup on top */
             draw_dcnow_tr();
         } break;
+        case DRAW_SEARCH: {
+            /* Search popup on top */
+            draw_search_tr();
+        } break;
         default:
         case DRAW_UI: {
             /* always drawn */
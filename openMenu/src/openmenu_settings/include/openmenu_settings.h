@@ -279,7 +279,7 @@ typedef enum CFG_DCNOW_VMU {
 
 typedef CFG_REGION region;
 
-enum draw_state { DRAW_UI = 0, DRAW_MULTIDISC, DRAW_EXIT, DRAW_MENU, DRAW_CREDITS, DRAW_CODEBREAKER, DRAW_PSX_LAUNCHER, DRAW_SAVELOAD, DRAW_DCNOW_PLAYERS };
+enum draw_state { DRAW_UI = 0, DRAW_MULTIDISC, DRAW_EXIT, DRAW_MENU, DRAW_CREDITS, DRAW_CODEBREAKER, DRAW_PSX_LAUNCHER, DRAW_SAVELOAD, DRAW_DCNOW_PLAYERS, DRAW_SEARCH };
 
 void settings_sanitize();
 
@@ -17,6 +17,29 @@
 #include <kos/fs.h>
 #endif
 
+#define DAT_VERSION_HASHED (1) /* Item table in any order, hashed at load */
+#define DAT_VERSION_SORTED (2) /* Item table presorted by ID, searched in place */
+#define DAT_VERSION_PACKED (3) /* Sorted table with byte offset + length, chunks LZ4 compressed */
+#define DAT_VERSION_CHECKED (4) /* ver3 followed by a CRC32C of each stored chunk, one per table entry */
+
+/* ver3 and up share the packed table and chunk layout */
+#define DAT_VERSION_IS_PACKED(v) ((v) >= DAT_VERSION_PACKED)
+
+#define DAT_INDEX_NONE (0xFFFFFFFF)
+
+/* On disk item table entry */
+typedef struct bin_item_raw {
+    char ID[12];
+    uint32_t offset;
+} bin_item_raw;
+
+/* On disk item table entry for ver3 */
+typedef struct bin_item_packed {
+    char ID[12];
+    uint32_t offset; /* Byte offset from the start of the file */
+    uint32_t length; /* Stored size, chunk_size means stored uncompressed */
+} bin_item_packed;
+
 typedef struct bin_item {
     char ID[12];
     uint32_t offset;
@@ -31,9 +54,9 @@ typedef struct bin_header {
         } rich;
 
         uint32_t raw;
-    } magic; /* DAT1 : DAT + single digit version */
+    } magic; /* DAT1 : DAT + single digit version, DAT2 = sorted item table, DAT3 = compressed, DAT4 = checksummed */
 
-    uint32_t chunk_size; /* Size of each chunk in the file */
+    uint32_t chunk_size; /* Size of each chunk in the file, uncompressed size for ver3 */
     uint32_t num_chunks; /* How many chunks are present in this bin */
     uint32_t padding0;   /* Unused in ver1 */
 } bin_header;
@@ -41,20 +64,34 @@ typedef struct bin_header {
 typedef struct dat_file {
     uint32_t chunk_size; /* Size of each chunk in the file */
     uint32_t num_chunks; /* How many chunks are present in this bin */
+    uint32_t version;     /* DAT_VERSION_* of the loaded file */
+    uint32_t first_chunk; /* Lowest chunk index holding data */
 #ifdef STANDALONE_BINARY
     FILE* handle;
 #else
     file_t handle; /* Open File Handle, commonly FILE* */
 #endif
-    bin_item* items; /* Holds actual data */
-    bin_item* hash;  /* Hash table for above */
+    bin_item_raw* index;     /* Item table as stored on disk, ver1 and ver2 */
+    bin_item* items;         /* Hashable copy of the item table, ver1 only */
+    bin_item* hash;          /* Hash table for above, ver1 only */
+    bin_item_packed* packed; /* Item table as stored on disk, ver3 only */
+    void* scratch;           /* Holds one compressed chunk, ver3 only */
+    uint32_t* crc;           /* CRC32C per table entry, ver4 on host tools or DAT_VERIFY builds */
+    uint8_t* verified;       /* Bit per table entry already checked, DAT_VERIFY builds only */
 } dat_file;
 
 int DAT_init(dat_file* bin);
 int DAT_load_parse(dat_file* bin, const char* path);
+void DAT_close(dat_file* bin);
 void DAT_info(const dat_file* bin);
 
 uint32_t DAT_get_offset_by_ID(const dat_file* bin, const char* ID);
+/* Chunk index, or table position for ver3 which has no fixed chunk grid, likewise for _by_num */
 uint32_t DAT_get_index_by_ID(const dat_file* bin, const char* ID);
 int DAT_read_file_by_ID(const dat_file* bin, const char* ID, void* buf);
 int DAT_read_file_by_num(const dat_file* bin, uint32_t chunk_num, void* buf);
+
+/* Orders an item table for writing a DAT_VERSION_SORTED file */
+void DAT_sort_index(bin_item_raw* items, uint32_t num_items);
+/* Same for a DAT_VERSION_PACKED table */
+void DAT_sort_packed_index(bin_item_packed* items, uint32_t num_items);
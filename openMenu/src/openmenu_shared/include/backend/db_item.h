@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 typedef enum FLAGS_GENRE {
     GENRE_NONE = (0 << 0),       // 0
     GENRE_ACTION = (1 << 0),     // 1
@@ -50,6 +52,9 @@ typedef enum FLAGS_ACCESORIES {
     ACCESORIES_UNUSED2 = (1 << 15),     // 32768
 } FLAGS_ACCESORIES;
 
+#define DB_DESCRIPTION_LEN (376) /* Longest description kept, including the NUL */
+
+/* In memory, descriptions live in one shared string pool */
 typedef struct db_item {
     unsigned char num_players;
     unsigned char vmu_blocks;
@@ -58,5 +63,29 @@ typedef struct db_item {
     unsigned short genre;      /* Genres Described above */
     char padding1;             /*Currently Unused, for expansion */
     char padding2;             /*Currently Unused, for expansion */
-    char description[376];
+    const char* description;
 } db_item;
+
+/* Compact META.DAT chunk, the pool follows the last chunk as a uint32_t size then the strings */
+typedef struct db_item_packed {
+    unsigned char num_players;
+    unsigned char vmu_blocks;
+    unsigned char accessories;
+    unsigned char network;
+    unsigned short genre;
+    char padding1;
+    char padding2;
+    uint32_t description; /* Byte offset into the string pool */
+} db_item_packed;
+
+/* Original META.DAT chunk with the description inline, still written by the card manager */
+typedef struct db_item_legacy {
+    unsigned char num_players;
+    unsigned char vmu_blocks;
+    unsigned char accessories;
+    unsigned char network;
+    unsigned short genre;
+    char padding1;
+    char padding2;
+    char description[DB_DESCRIPTION_LEN];
+} db_item_legacy;
@@ -10,8 +10,14 @@
 
 #pragma once
 
+/* Longest name and folder kept from the INI, NUL included */
+#define GD_ITEM_MAX_name   (128)
+#define GD_ITEM_MAX_folder (512)
+
+/* name and folder point into the list string pool, each distinct folder
+ * path is stored once. Field order matches the static DIR initializers */
 typedef struct gd_item {
-    char name[128];
+    const char* name;
     char date[12];
     char product[12];
     char disc[8];
@@ -19,10 +25,21 @@ typedef struct gd_item {
     char region[4];
     unsigned int slot_num;
     char vga[1];
-    char folder[512];
+    const char* folder;
     char type[8];
+    const char* art_id;  /* Serials after the remaps, resolved at load. NULL */
+    const char* meta_id; /* when product is used as is */
 } gd_item;
 
+/* What to look an item up by in the art DATs and META.DAT */
+static inline const char* gd_item_art_id(const gd_item* item) {
+    return item->art_id ? item->art_id : item->product;
+}
+
+static inline const char* gd_item_meta_id(const gd_item* item) {
+    return item->meta_id ? item->meta_id : item->product;
+}
+
 /* Helper functions to parse disc field "N/M" format (supports 1-10) */
 static inline int gd_item_disc_num(const char* disc) {
     /* Parse current disc number before '/' */
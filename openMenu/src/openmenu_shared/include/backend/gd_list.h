@@ -13,6 +13,14 @@
 struct gd_item;
 int list_read(const char* filename);
 int list_read_default(void);
+/* Loads LIST.BIN instead of parsing filename when it was made from that exact INI */
+int list_read_snapshot(const char* filename, const char* snapshot);
+#ifdef STANDALONE_BINARY
+/* Parses filename and writes the LIST.BIN for it */
+int list_write_snapshot(const char* filename, const char* snapshot);
+/* The ini_parse_string handler list_read uses, for timing dispatch on its own */
+int list_ini_handler(void* user, const char* section, const char* name, const char* value);
+#endif
 void list_destroy(void);
 void list_print_slots(void);
 void list_print_temp(void);
@@ -29,6 +37,25 @@ void list_set_sort_alphabetical(void);
 void list_set_genre(int genre);
 void list_set_genre_sort(int genre, int sort);
 void list_set_sort_filter(const char type, int num);
+/* Intersection of filters answered from bitmap indexes, in name order */
+typedef struct list_filter {
+    int genre;       /* Genre bit 0-15, 16 for no genre, -1 for any */
+    int region;      /* 0 NTSC-J, 1 NTSC-U, 2 PAL, 3 region free, -1 for any */
+    int letter;      /* 0 not a letter, 1-26 A to Z, -1 for any */
+    int accessory;   /* FLAGS_ACCESORIES bit 0-7, -1 for any */
+    int min_players; /* 0 for any */
+} list_filter;
+void list_set_filter(const list_filter* filter);
+int list_filter_count(const list_filter* filter);
+/* Type-ahead search over names, names starting with query first then names
+ * containing it, case folded. Typing on from the last query only rechecks its
+ * matches. An empty query lists every game by name. Returns how many matched */
+int list_set_search(const char* query);
+/* Builds the search index up front, so the first key typed is as quick as the rest */
+void list_search_prepare(void);
+/* Shows the results of query again without searching, when it was the last
+ * query to match anything. Returns how many, or -1 when they are not kept */
+int list_search_restore(const char* query);
 /* Grab multidisc games */
 void list_set_multidisc(const char* product_id);
 void list_set_multidisc_filtered(const char* product_id, const char* folder_path);
@@ -36,8 +63,15 @@ const struct gd_item** list_get_multidisc(void);
 int list_count_multidisc_filtered(const char* product_id, const char* folder_path);
 
 int list_length(void);
+/* Changes whenever list_get would show different items, even from the same array */
+unsigned int list_generation(void);
 int list_multidisc_length(void);
 const struct gd_item* list_item_get(int idx);
+/* Every loaded slot by a fixed index, for tables built once over the whole list.
+ * list_slot_index is -1 for folders and the other built in entries */
+int list_slot_count(void);
+const struct gd_item* list_slot_get(int idx);
+int list_slot_index(const struct gd_item* item);
 
 /* Folder navigation functions */
 void list_folder_init(void);
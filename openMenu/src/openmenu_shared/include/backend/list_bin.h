@@ -0,0 +1,35 @@
+/*
+ * File: list_bin.h
+ * Project: backend
+ * File Created: Friday, 16th October 2026 7:10:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define LIST_BIN_VERSION (1)
+
+/* LIST.BIN, OPENMENU.INI already parsed. Only used while the INI beside it
+ * still hashes the same, anything else falls back to parsing the INI */
+typedef struct list_bin_header {
+    union {
+        struct {
+            char alpha[3];
+            char version;
+        } rich;
+
+        uint32_t raw;
+    } magic; /* LST + single digit version */
+
+    uint32_t num_items; /* Slots that follow, empty ones included */
+    uint32_t ini_size;  /* Size of the OPENMENU.INI they were parsed from */
+    uint32_t ini_crc;   /* CRC32C of that INI */
+    uint32_t data_size; /* Bytes of slot records after this header */
+} list_bin_header;
+
+/* Each slot is a uint32_t slot_num then every gd_item.def field as a NUL
+ * terminated string, in .def order. name and folder are pool pointers in a
+ * gd_item, so there is no raw image to store */
@@ -0,0 +1,15 @@
+/*
+ * File: crc32c.h
+ * Project: texture
+ * File Created: Friday, 16th October 2026 5:40:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* CRC32C (Castagnoli), pass 0 to start and the previous result to continue */
+uint32_t crc32c(uint32_t crc, const void* data, size_t len);
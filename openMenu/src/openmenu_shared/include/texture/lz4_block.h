@@ -0,0 +1,17 @@
+/*
+ * File: lz4_block.h
+ * Project: texture
+ * File Created: Friday, 16th October 2026 1:05:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+
+#pragma once
+
+/* Plain LZ4 block format, no frame header or checksums */
+
+/* Returns compressed size, or 0 if the result would not fit in dst_cap or out of memory */
+int lz4_block_compress(const void* src, int src_len, void* dst, int dst_cap);
+
+/* Returns decompressed size, or -1 on malformed input or overflowing dst_cap */
+int lz4_block_decompress(const void* src, int src_len, void* dst, int dst_cap);
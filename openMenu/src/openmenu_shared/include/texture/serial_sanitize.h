@@ -10,6 +10,8 @@
 
 #pragma once
 
+/* All return id itself when nothing applies. List items resolve these once at
+ * load, see gd_item_art_id and gd_item_meta_id */
+const char* serial_fix_product(const char* id, const char* date, const char* name);
 const char* serial_santize_art(const char* id);
 const char* serial_santize_meta(const char* id);
-int serial_sanitizer_init(void);
@@ -10,21 +10,177 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "backend/db_list.h"
 #include "backend/dat_format.h"
-#include "texture/serial_sanitize.h"
 #include "backend/db_item.h"
 
 static dat_file dat_meta;
 static db_item* db;
+static char* db_strings; /* Every description once, NUL terminated */
 static int dat_first_index;
 
+#define DB_LEGACY_BATCH (16) /* Legacy chunks read per fs_read */
+
+/* Compact chunks, the records and then the pool in one read each */
+static int
+db_load_packed(void) {
+    const size_t records_size = dat_meta.num_chunks * sizeof(db_item_packed);
+    db_item_packed* records = malloc(records_size);
+    if (!records) {
+        printf("%s no free memory\n", __func__);
+        return 1;
+    }
+    uint32_t pool_size = 0;
+    if (fs_read(dat_meta.handle, records, records_size) != (ssize_t)records_size
+        || fs_read(dat_meta.handle, &pool_size, sizeof(pool_size)) != (ssize_t)sizeof(pool_size)) {
+        printf("DAT:Error META.DAT is truncated!\n");
+        free(records);
+        return 1;
+    }
+
+    /* The pool cannot be bigger than what is left of the file */
+    const off_t pool_start = fs_tell(dat_meta.handle);
+    const size_t file_size = fs_total(dat_meta.handle);
+    if (pool_start < 0 || (size_t)pool_start > file_size || pool_size > file_size - (size_t)pool_start) {
+        printf("DAT:Error META.DAT string pool of %u bytes is corrupt!\n", (unsigned int)pool_size);
+        free(records);
+        return 1;
+    }
+    db_strings = malloc(pool_size + 1);
+    if (!db_strings) {
+        printf("%s no free memory\n", __func__);
+        free(records);
+        return 1;
+    }
+    if (fs_read(dat_meta.handle, db_strings, pool_size) != (ssize_t)pool_size) {
+        printf("DAT:Error META.DAT is truncated!\n");
+        free(records);
+        return 1;
+    }
+    /* Doubles as the empty string for anything pointing outside the pool */
+    db_strings[pool_size] = '\0';
+
+    for (unsigned int i = 0; i < dat_meta.num_chunks; i++) {
+        db[i].num_players = records[i].num_players;
+        db[i].vmu_blocks = records[i].vmu_blocks;
+        db[i].accessories = records[i].accessories;
+        db[i].network = records[i].network;
+        db[i].genre = records[i].genre;
+        db[i].padding1 = records[i].padding1;
+        db[i].padding2 = records[i].padding2;
+        db[i].description = db_strings + ((records[i].description < pool_size) ? records[i].description : pool_size);
+    }
+    free(records);
+    return 0;
+}
+
+static uint32_t
+db_hash_string(const char* str) {
+    uint32_t hash = 2166136261u;
+    while (*str) {
+        hash = (hash ^ (unsigned char)*str++) * 16777619u;
+    }
+    return hash;
+}
+
+/* Fixed size chunks from older tools, the descriptions are copied out into a
+ * deduplicated pool a few chunks at a time so the full file is never resident */
+static int
+db_load_legacy(void) {
+    const uint32_t num_chunks = dat_meta.num_chunks;
+    uint32_t table_size = 16;
+    while (table_size < num_chunks * 2) {
+        table_size <<= 1;
+    }
+    db_item_legacy* batch = malloc(DB_LEGACY_BATCH * sizeof(db_item_legacy));
+    uint32_t* offsets = malloc(num_chunks * sizeof(uint32_t)); /* Pool moves while growing */
+    uint32_t* seen = malloc(table_size * sizeof(uint32_t));    /* Pool offset + 1 per string, 0 is empty */
+    uint32_t pool_cap = 4096;
+    uint32_t pool_len = 0;
+    db_strings = malloc(pool_cap);
+    if (!batch || !offsets || !seen || !db_strings) {
+        printf("%s no free memory\n", __func__);
+        free(batch);
+        free(offsets);
+        free(seen);
+        return 1;
+    }
+    memset(seen, 0, table_size * sizeof(uint32_t));
+
+    for (uint32_t first = 0; first < num_chunks; first += DB_LEGACY_BATCH) {
+        const uint32_t count = (num_chunks - first < DB_LEGACY_BATCH) ? num_chunks - first : DB_LEGACY_BATCH;
+        if (fs_read(dat_meta.handle, batch, count * sizeof(db_item_legacy))
+            != (ssize_t)(count * sizeof(db_item_legacy))) {
+            printf("DAT:Error META.DAT is truncated!\n");
+            free(batch);
+            free(offsets);
+            free(seen);
+            return 1;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            db_item* item = &db[first + i];
+            char* desc = batch[i].description;
+            desc[DB_DESCRIPTION_LEN - 1] = '\0';
+
+            item->num_players = batch[i].num_players;
+            item->vmu_blocks = batch[i].vmu_blocks;
+            item->accessories = batch[i].accessories;
+            item->network = batch[i].network;
+            item->genre = batch[i].genre;
+            item->padding1 = batch[i].padding1;
+            item->padding2 = batch[i].padding2;
+
+            uint32_t slot = db_hash_string(desc) & (table_size - 1);
+            while (seen[slot] && strcmp(db_strings + seen[slot] - 1, desc)) {
+                slot = (slot + 1) & (table_size - 1);
+            }
+            if (!seen[slot]) {
+                const uint32_t len = strlen(desc) + 1;
+                if (pool_len + len > pool_cap) {
+                    while (pool_len + len > pool_cap) {
+                        pool_cap *= 2;
+                    }
+                    char* grown = realloc(db_strings, pool_cap);
+                    if (!grown) {
+                        printf("%s no free memory\n", __func__);
+                        free(batch);
+                        free(offsets);
+                        free(seen);
+                        return 1;
+                    }
+                    db_strings = grown;
+                }
+                memcpy(db_strings + pool_len, desc, len);
+                seen[slot] = pool_len + 1;
+                pool_len += len;
+            }
+            offsets[first + i] = seen[slot] - 1;
+        }
+    }
+
+    /* Give back the growth slack, then the pool is fixed and safe to point into */
+    char* shrunk = realloc(db_strings, pool_len ? pool_len : 1);
+    if (shrunk) {
+        db_strings = shrunk;
+    }
+    for (uint32_t i = 0; i < num_chunks; i++) {
+        db[i].description = db_strings + offsets[i];
+    }
+    free(batch);
+    free(offsets);
+    free(seen);
+    return 0;
+}
+
 int
 db_load_DAT(void) {
     DAT_init(&dat_meta);
     DAT_load_parse(&dat_meta, "META.DAT");
-    dat_first_index = dat_meta.items[0].offset;
+    dat_first_index = dat_meta.first_chunk;
 
     /* Read DAT to db, but use Hash table to quickly search */
     db = malloc(dat_meta.num_chunks * sizeof(db_item));
@@ -32,8 +188,26 @@ db_load_DAT(void) {
         printf("%s no free memory\n", __func__);
         return 0;
     }
-    fs_read(dat_meta.handle, db, dat_meta.num_chunks * sizeof(db_item));
+
+    /* Chunk size tells the two layouts apart */
+    int ret = 0;
+    if (dat_meta.chunk_size == sizeof(db_item_packed)) {
+        ret = db_load_packed();
+    } else if (dat_meta.chunk_size == sizeof(db_item_legacy)) {
+        ret = db_load_legacy();
+    } else if (dat_meta.num_chunks) {
+        printf("DAT:Error Unknown META.DAT chunk size %u!\n", (unsigned int)dat_meta.chunk_size);
+        ret = 1;
+    }
     fs_close(dat_meta.handle);
+    if (ret) {
+        /* Lookups then never find anything */
+        free(db);
+        free(db_strings);
+        db = NULL;
+        db_strings = NULL;
+        return 0;
+    }
 
     DAT_info(&dat_meta);
 
@@ -44,10 +218,9 @@ db_load_DAT(void) {
  * item = NULL */
 int
 db_get_meta(const char* id, struct db_item** item) {
-    const char* id_santized = serial_santize_meta(id);
-    uint32_t index = DAT_get_index_by_ID(&dat_meta, id_santized);
+    uint32_t index = db ? DAT_get_index_by_ID(&dat_meta, id) : DAT_INDEX_NONE;
 
-    if (index == 0xFFFFFFFF) {
+    if (index == DAT_INDEX_NONE) {
         *item = NULL;
         return 1;
     }
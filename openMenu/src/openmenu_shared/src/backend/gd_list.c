@@ -10,6 +10,7 @@
  */
 
 #include <ctype.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,6 +22,9 @@
 #include "backend/db_list.h"
 #include "backend/gd_item.h"
 #include "backend/gd_list.h"
+#include "backend/list_bin.h"
+#include "texture/crc32c.h"
+#include "texture/serial_sanitize.h"
 
 #ifdef _arch_dreamcast
 #include <kos/fs.h>
@@ -44,6 +48,7 @@ static gd_item** list_temp = NULL;
 
 static int num_items_current = -1;
 static gd_item** list_current = NULL;
+static unsigned int list_gen = 0; /* Bumped whenever list_current is rebuilt */
 
 static int num_items_alphabet = 27;
 static const struct gd_item list_alphabet_tmp[27] = {
@@ -103,18 +108,23 @@ static struct gd_item back_button = {"Back", "", " ", "DIR", "", "", 0, {' '}, "
 /* Folder tree system for hierarchical navigation */
 #define MAX_FOLDER_DEPTH 8
 #define MAX_FOLDER_PATH 512
-#define MAX_FOLDER_NODES 1024
-#define MAX_FOLDER_CHILDREN 1024
 
 typedef struct folder_node {
-    char name[256];
+    const char* name;       /* Interned in the string pool, equal names are equal pointers */
+    const char* label;      /* "[name]" in the string pool, shown as the folder entry */
     struct folder_node* parent;
-    struct folder_node* children[MAX_FOLDER_CHILDREN];
+    struct folder_node** children; /* Grows by doubling, found through folder_hash */
     int num_children;
+    int children_capacity;
     gd_item** games;        /* Dynamic array of game pointers */
     int num_games;          /* Current number of games */
     int games_capacity;     /* Allocated capacity */
     int first_seen_slot;    /* Slot number of first game with this folder path */
+    /* Filled once bottom-up by folder_count_visible, [0] showing every disc and
+     * [1] with multi-disc sets collapsed, so toggling sf_multidisc needs no recount */
+    int visible_games[2];      /* This folder's own games */
+    int visible_subfolders[2]; /* Children with something visible below them */
+    int visible_total[2];      /* Games visible anywhere in this subtree */
 } folder_node_t;
 
 typedef struct {
@@ -125,16 +135,204 @@ typedef struct {
 } folder_state_t;
 
 static folder_node_t* folder_tree_root = NULL;
+
+/* Every child in the tree keyed by parent and interned name, so a lookup
+ * compares two pointers. A NULL parent maps a whole interned folder path to
+ * its deepest node, letting games in the same folder skip the walk */
+typedef struct folder_hash_entry {
+    const folder_node_t* parent;
+    const char* name;
+    folder_node_t* node;
+} folder_hash_entry;
+
+/* Per slot, set for the discs a collapsed multi-disc set hides in its folder */
+static unsigned char* folder_disc_hidden = NULL;
+
+static folder_hash_entry* folder_hash = NULL;
+static size_t folder_hash_size = 0;
+static size_t folder_hash_count = 0;
 static folder_state_t folder_state = {{0}, 0, {{0}}, {0}};
 static struct gd_item parent_button = {"[..]", "", "F..", "DIR", "", "", 0, {' '}, ""};
-static struct gd_item folder_items[MAX_FOLDER_NODES];
+static struct gd_item* folder_items = NULL; /* Entries for the listed folder's children, grows by doubling */
+static int folder_items_capacity = 0;
 static int folder_items_count = 0;
 
+/* Games presorted once per load, skipping openMenu in slot 0. Views copy or
+ * filter these in order instead of sorting on every switch */
+static gd_item** list_by_name = NULL;   /* Case folded name, then SD order */
+static gd_item** list_by_region = NULL; /* Region, then SD order */
+static uint32_t* list_name_rank = NULL; /* Position of each slot in list_by_name */
+
+/* Bitmap indexes, bit p is the p-th game in list_by_name. Built on first use
+ * because genres come from META.DAT, which loads after the list */
+enum {
+    LIST_INDEX_GENRE = 0,                            /* 16 genre bits then "No genre" */
+    LIST_INDEX_REGION = LIST_INDEX_GENRE + 17,       /* J, U, E, region free */
+    LIST_INDEX_LETTER = LIST_INDEX_REGION + 4,       /* Not a letter, then A to Z */
+    LIST_INDEX_ACCESSORY = LIST_INDEX_LETTER + 27,   /* FLAGS_ACCESORIES bits that fit db_item */
+    LIST_INDEX_PLAYERS = LIST_INDEX_ACCESSORY + 8,   /* At least 1 to 4 players */
+    LIST_INDEX_HIDDEN = LIST_INDEX_PLAYERS + 4,      /* Hidden when multi-disc sets are collapsed */
+    LIST_INDEX_RESULT = LIST_INDEX_HIDDEN + 1,       /* Scratch for the last query */
+    LIST_INDEX_SETS = LIST_INDEX_RESULT + 1,
+};
+static uint32_t* list_index = NULL;
+static int list_index_words = 0;
+
+/* Type-ahead search. Every distinct 1, 2 and 3 char window of a case folded
+ * name is posted under a bucket, single chars exactly and longer windows
+ * hashed, so a query only rechecks the games under its rarest window */
+#define LIST_SEARCH_MAX     (64)                       /* Longest query kept, including the NUL */
+#define LIST_SEARCH_HASHED  (8192)                     /* Buckets shared by 2 and 3 char windows */
+#define LIST_SEARCH_BUCKETS (256 + LIST_SEARCH_HASHED) /* Single chars first */
+
+static uint32_t* list_search_offset = NULL; /* Start of each bucket in list_search_post, plus the end */
+static uint16_t* list_search_post = NULL;   /* Positions in list_by_name, ascending per bucket */
+static gd_item** list_search_hits = NULL;   /* Last result, typing on only rechecks these */
+static int num_search_hits = -1;
+static int list_search_hide = 0;
+static char list_search_query[LIST_SEARCH_MAX];
+
 /* Temporary list for holding all multidisc games in a set */
 #define MULTIDISC_MAX_GAMES_PER_SET (10)
 static int num_items_multidisc = -1;
 static gd_item* list_multidisc[MULTIDISC_MAX_GAMES_PER_SET] = {NULL};
 
+/* Games grouped by product ID once per load, each set by disc number then SD
+ * order. The hash maps a product ID to its run, so sets are found without a scan */
+typedef struct list_product_set {
+    uint32_t first;
+    uint32_t count; /* 0 marks a free slot */
+} list_product_set;
+
+static gd_item** list_by_product = NULL;
+static list_product_set* list_product_hash = NULL;
+static uint32_t list_product_mask = 0;
+
+/* Names and folder paths. Items point straight into these blocks, which never move */
+#define LIST_POOL_BLOCK (16 * 1024)
+
+typedef struct list_pool_block {
+    struct list_pool_block* next;
+    size_t used;
+    size_t size;
+    char data[];
+} list_pool_block;
+
+static list_pool_block* list_pool = NULL;
+
+/* Every distinct string in the pool, open addressed, so a folder path shared by
+ * a hundred games is stored once */
+static const char** list_pool_hash = NULL;
+static size_t list_pool_hash_size = 0;
+static size_t list_pool_count = 0;
+
+static uint32_t
+list_pool_fnv(const char* str, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (unsigned char)str[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static const char*
+list_pool_add(const char* str, size_t len) {
+    if (!list_pool || list_pool->size - list_pool->used < len + 1) {
+        const size_t size = (len + 1 > LIST_POOL_BLOCK) ? len + 1 : LIST_POOL_BLOCK;
+        list_pool_block* block = malloc(sizeof(list_pool_block) + size);
+        if (!block) {
+            printf("%s no free memory\n", __func__);
+            return "";
+        }
+        block->next = list_pool;
+        block->used = 0;
+        block->size = size;
+        list_pool = block;
+    }
+    char* dst = list_pool->data + list_pool->used;
+    memcpy(dst, str, len);
+    dst[len] = '\0';
+    list_pool->used += len + 1;
+    return dst;
+}
+
+static int
+list_pool_grow(void) {
+    const size_t size = list_pool_hash_size ? list_pool_hash_size * 2 : 256;
+    const char** hash = calloc(size, sizeof(const char*));
+    if (!hash) {
+        return -1;
+    }
+    for (size_t i = 0; i < list_pool_hash_size; i++) {
+        if (list_pool_hash[i]) {
+            size_t h = list_pool_fnv(list_pool_hash[i], strlen(list_pool_hash[i])) & (size - 1);
+            while (hash[h]) {
+                h = (h + 1) & (size - 1);
+            }
+            hash[h] = list_pool_hash[i];
+        }
+    }
+    free(list_pool_hash);
+    list_pool_hash = hash;
+    list_pool_hash_size = size;
+    return 0;
+}
+
+/* Pooled copy of the first len chars of str, shared with any equal string */
+static const char*
+list_pool_intern(const char* str, size_t len) {
+    if (!len) {
+        return "";
+    }
+    if ((list_pool_count + 1) * 2 > list_pool_hash_size && list_pool_grow()) {
+        /* Still correct, just not shared */
+        return list_pool_add(str, len);
+    }
+    size_t h = list_pool_fnv(str, len) & (list_pool_hash_size - 1);
+    for (; list_pool_hash[h]; h = (h + 1) & (list_pool_hash_size - 1)) {
+        if (!strncmp(list_pool_hash[h], str, len) && list_pool_hash[h][len] == '\0') {
+            return list_pool_hash[h];
+        }
+    }
+    const char* pooled = list_pool_add(str, len);
+    if (*pooled) {
+        list_pool_hash[h] = pooled;
+        list_pool_count++;
+    }
+    return pooled;
+}
+
+/* Pooled string equal to the first len chars of str, NULL if there is none */
+static const char*
+list_pool_find(const char* str, size_t len) {
+    if (!len) {
+        return "";
+    }
+    if (!list_pool_hash) {
+        return NULL;
+    }
+    size_t h = list_pool_fnv(str, len) & (list_pool_hash_size - 1);
+    for (; list_pool_hash[h]; h = (h + 1) & (list_pool_hash_size - 1)) {
+        if (!strncmp(list_pool_hash[h], str, len) && list_pool_hash[h][len] == '\0') {
+            return list_pool_hash[h];
+        }
+    }
+    return NULL;
+}
+
+static void
+list_pool_destroy(void) {
+    while (list_pool) {
+        list_pool_block* next = list_pool->next;
+        free(list_pool);
+        list_pool = next;
+    }
+    free(list_pool_hash);
+    list_pool_hash = NULL;
+    list_pool_hash_size = 0;
+    list_pool_count = 0;
+}
+
 #ifndef STANDALONE_BINARY
 static inline long int
 filelength(file_t f) {
@@ -152,6 +350,78 @@ filelength(FILE* f) {
 }
 #endif
 
+static int
+list_alloc_slots(int num_items) {
+    gd_slots_BASE = malloc((num_items + 1) * sizeof(struct gd_item));
+    list_temp = malloc((num_items + 1) * sizeof(struct gd_item*));
+    if (!gd_slots_BASE || !list_temp) {
+        printf("%s no free memory\n", __func__);
+        list_destroy();
+        return -1;
+    }
+    memset(gd_slots_BASE, '\0', (num_items + 1) * sizeof(struct gd_item));
+    memset(list_temp, '\0', (num_items + 1) * sizeof(struct gd_item*));
+    for (int i = 0; i < num_items + 1; i++) {
+#define CFG(s, n, default)
+#define CFG_POOL(s, n, default) gd_slots_BASE[i].n = "";
+#include "backend/gd_item.def"
+    }
+    memset(list_multidisc, '\0', MULTIDISC_MAX_GAMES_PER_SET * sizeof(struct gd_item*));
+    return 0;
+}
+
+/* Every gd_item.def key, looked up by hash instead of testing each in turn */
+typedef struct list_ini_key {
+    const char* section;
+    const char* name;
+    size_t len;
+    size_t offset;
+    size_t size; /* Longest value kept, NUL included */
+    int pooled;  /* const char* into the string pool rather than a char array */
+} list_ini_key;
+
+static const list_ini_key list_ini_keys[] = {
+#define CFG(s, n, default)      {#s, #n, sizeof(#n) - 1, offsetof(gd_item, n), sizeof(((gd_item*)0)->n), 0},
+#define CFG_POOL(s, n, default) {#s, #n, sizeof(#n) - 1, offsetof(gd_item, n), GD_ITEM_MAX_##n, 1},
+#include "backend/gd_item.def"
+};
+#define LIST_INI_NUM_KEYS (sizeof(list_ini_keys) / sizeof(list_ini_keys[0]))
+
+/* Open addressed, collision free for the current keys so a lookup is one compare */
+#define LIST_INI_HASH_SIZE (32)
+#define LIST_INI_HASH(key, len)                                                                                        \
+    (((((unsigned)(key)[0] | 32) << 3) ^ ((unsigned)(key)[1] | 32) ^ ((unsigned)(len) << 4)) & (LIST_INI_HASH_SIZE - 1))
+static uint8_t list_ini_hash[LIST_INI_HASH_SIZE]; /* index + 1, 0 is empty */
+
+static void
+list_ini_hash_init(void) {
+    if (list_ini_hash[LIST_INI_HASH(list_ini_keys[0].name, list_ini_keys[0].len)]) {
+        return;
+    }
+    for (size_t i = 0; i < LIST_INI_NUM_KEYS; i++) {
+        unsigned h = LIST_INI_HASH(list_ini_keys[i].name, list_ini_keys[i].len);
+        while (list_ini_hash[h]) {
+            h = (h + 1) & (LIST_INI_HASH_SIZE - 1);
+        }
+        list_ini_hash[h] = (uint8_t)(i + 1);
+    }
+}
+
+static const list_ini_key*
+list_ini_key_find(const char* section, const char* name) {
+    const size_t len = strlen(name);
+    if (!len) {
+        return NULL;
+    }
+    for (unsigned h = LIST_INI_HASH(name, len); list_ini_hash[h]; h = (h + 1) & (LIST_INI_HASH_SIZE - 1)) {
+        const list_ini_key* key = &list_ini_keys[list_ini_hash[h] - 1];
+        if (key->len == len && !strcasecmp(key->name, name) && !strcasecmp(key->section, section)) {
+            return key;
+        }
+    }
+    return NULL;
+}
+
 static int
 read_openmenu_ini(void* user, const char* section, const char* name, const char* value) {
     /* unused */
@@ -160,28 +430,24 @@ read_openmenu_ini(void* user, const char* section, const char* name, const char*
     if ((strcmp(section, "OPENMENU") == 0) && (strcmp(name, "num_items") == 0)) {
         num_items_BASE = atoi(value) /* It can occur that GDMenuCardManager under reports by 1 */;
         num_items_temp = num_items_BASE - 1;
-        gd_slots_BASE = malloc((num_items_BASE + 1) * sizeof(struct gd_item));
-        if (!gd_slots_BASE) {
-            printf("%s no free memory\n", __func__);
+        if (list_alloc_slots(num_items_BASE)) {
             return 0;
         }
-        list_temp = malloc((num_items_BASE + 1) * sizeof(struct gd_item*));
-        if (!list_temp) {
-            printf("%s no free memory\n", __func__);
-            return 0;
-        }
-
-        memset(gd_slots_BASE, '\0', (num_items_BASE + 1) * sizeof(struct gd_item));
-        memset(list_temp, '\0', (num_items_BASE + 1) * sizeof(struct gd_item*));
-        memset(list_multidisc, '\0', MULTIDISC_MAX_GAMES_PER_SET * sizeof(struct gd_item*));
+        list_ini_hash_init();
     } else {
-        /* Parsing games */
-        char slot_string[4] = {0, 0, 0, 0};
-        uintptr_t seperator = (uintptr_t)strchr(name, '.');
-        if (seperator) {
-            size_t temp_len = (size_t)(seperator - (uintptr_t)name);
-            memcpy(slot_string, name, temp_len);
-            int slot = atoi(slot_string);
+        /* Parsing games, keys are NNN.field */
+        int slot = 0;
+        const char* plain_name = name;
+        while (*plain_name >= '0' && *plain_name <= '9') {
+            slot = slot * 10 + (*plain_name++ - '0');
+        }
+        if (*plain_name == '.' && plain_name != name) {
+            plain_name++;
+            /* Room for num_items + 1 slots, see list_alloc_slots */
+            if (!gd_slots_BASE || slot < 1 || slot > num_items_BASE + 1) {
+                printf("INI:Error slot %d out of range [%s] %s\n", slot, section, name);
+                return 1;
+            }
             num_items_read = slot;
 
             gd_item* item = &gd_slots_BASE[slot - 1];
@@ -189,16 +455,25 @@ read_openmenu_ini(void* user, const char* section, const char* name, const char*
                 item->slot_num = slot;
             }
 
-            const char* plain_name = name + temp_len + 1;
-
             // printf("[%s] %s: %s\n", section, plain_name, value);
 
-            if (0)
-                ;
-#define CFG(s, n, default)                                                                                             \
-    else if (strcasecmp(section, #s) == 0 && strcasecmp(plain_name, #n) == 0) strcpy(item->n, value);
-#include "backend/gd_item.def"
-
+            const list_ini_key* key = list_ini_key_find(section, plain_name);
+            if (key) {
+                /* Clipped to the field, a one char field like vga keeps no NUL */
+                char* field = (char*)item + key->offset;
+                size_t len = strlen(value);
+                if (len >= key->size) {
+                    len = (key->size > 1) ? key->size - 1 : key->size;
+                }
+                if (key->pooled) {
+                    *(const char**)field = list_pool_intern(value, len);
+                    return 1;
+                }
+                memcpy(field, value, len);
+                if (len < key->size) {
+                    field[len] = '\0';
+                }
+            }
         } else {
             /* error */
             printf("INI:Error unknown [%s] %s: %s\n", section, name, value);
@@ -212,7 +487,8 @@ list_print_slots(void) {
     for (int i = 0; i < num_items_BASE; i++) {
         printf("slot %d\n", i);
         gd_item* item = &gd_slots_BASE[i];
-#define CFG(s, n, default) printf("%s = %s\n", #n, item->n);
+#define CFG(s, n, default)      printf("%s = %.*s\n", #n, (int)sizeof(item->n), item->n);
+#define CFG_POOL(s, n, default) printf("%s = %s\n", #n, item->n);
 #include "backend/gd_item.def"
 
         printf("\n");
@@ -224,7 +500,8 @@ list_print_temp(void) {
     for (int i = 0; i < num_items_temp; i++) {
         printf("slot %d\n", i);
         gd_item* item = list_temp[i];
-#define CFG(s, n, default) printf("%s = %s\n", #n, item->n);
+#define CFG(s, n, default)      printf("%s = %.*s\n", #n, (int)sizeof(item->n), item->n);
+#define CFG_POOL(s, n, default) printf("%s = %s\n", #n, item->n);
 #include "backend/gd_item.def"
 
         printf("\n");
@@ -237,7 +514,8 @@ list_print(const gd_item** list) {
     for (int i = 0; i < num_items_temp; i++) {
         // printf("slot %d\n", i);
         const gd_item* item = list[i];
-#define CFG(s, n, default) printf("%s = %s\n", #n, item->n);
+#define CFG(s, n, default)      printf("%s = %.*s\n", #n, (int)sizeof(item->n), item->n);
+#define CFG_POOL(s, n, default) printf("%s = %s\n", #n, item->n);
 #include "backend/gd_item.def"
 
         printf("\n");
@@ -245,9 +523,18 @@ list_print(const gd_item** list) {
     printf("\n");
 }
 
+static int
+list_item_hidden(const gd_item* item, int hide_multidisc) {
+    int disc_num = gd_item_disc_num(item->disc);
+    int disc_set = gd_item_disc_total(item->disc);
+    /* Only hide multi-disc entries if they have a valid product code */
+    return hide_multidisc && disc_num > 1 && disc_set > 1 && item->product[0] != '\0';
+}
+
+/* Fills list_temp with the visible games of a presorted order, SD order when NULL */
 static void
-list_temp_reset(void) {
-    int base_idx, temp_idx = 0;
+list_temp_from(gd_item* const* order) {
+    int idx, temp_idx = 0;
 
 #ifdef _arch_dreamcast
     int hide_multidisc = sf_multidisc[0];
@@ -256,37 +543,666 @@ list_temp_reset(void) {
 #endif
 
     /* Skip openMenu itself */
-    for (base_idx = 1; base_idx < num_items_BASE; base_idx++) {
-        int disc_num = gd_item_disc_num(gd_slots_BASE[base_idx].disc);
-        int disc_set = gd_item_disc_total(gd_slots_BASE[base_idx].disc);
-        /* Only hide multi-disc entries if they have a valid product code */
-        if (hide_multidisc && disc_num > 1 && disc_set > 1 && gd_slots_BASE[base_idx].product[0] != '\0') {
+    for (idx = 0; idx < num_items_BASE - 1; idx++) {
+        gd_item* item = order ? order[idx] : &gd_slots_BASE[idx + 1];
+        if (list_item_hidden(item, hide_multidisc)) {
             continue;
         }
 
-        list_temp[temp_idx++] = &gd_slots_BASE[base_idx];
+        list_temp[temp_idx++] = item;
     }
     num_items_temp = temp_idx;
 }
 
+static void
+list_temp_reset(void) {
+    list_temp_from(NULL);
+}
+
+static int
+list_hide_multidisc(void) {
+#ifdef _arch_dreamcast
+    return sf_multidisc[0];
+#else
+    return 0;
+#endif
+}
+
+/* First four case folded chars, so most name compares while presorting are one integer compare */
+static uint32_t* list_name_key = NULL;
+
+static uint32_t
+list_collation_key(const char* name) {
+    uint32_t key = 0;
+    for (int i = 0; i < 4; i++) {
+        key = (key << 8) | (unsigned char)tolower((unsigned char)*name);
+        if (*name) {
+            name++;
+        }
+    }
+    return key;
+}
+
 static int
 struct_cmp_by_name(const void* a, const void* b) {
     const gd_item* ia = *(const gd_item**)a;
     const gd_item* ib = *(const gd_item**)b;
-    return strcasecmp(ia->name, ib->name);
+    const uint32_t ka = list_name_key[ia - gd_slots_BASE];
+    const uint32_t kb = list_name_key[ib - gd_slots_BASE];
+    if (ka != kb) {
+        return (ka > kb) - (ka < kb);
+    }
+    const int cmp = strcasecmp(ia->name, ib->name);
+    return cmp ? cmp : (int)ia->slot_num - (int)ib->slot_num;
 }
 
 static int
 struct_cmp_by_region(const void* a, const void* b) {
     const gd_item* ia = *(const gd_item**)a;
     const gd_item* ib = *(const gd_item**)b;
-    return strcmp(ia->region, ib->region);
+    const int cmp = strcmp(ia->region, ib->region);
+    return cmp ? cmp : (int)ia->slot_num - (int)ib->slot_num;
+}
+
+static void
+list_index_destroy(void) {
+    free(list_index);
+    list_index = NULL;
+    list_index_words = 0;
+}
+
+static void
+list_search_destroy(void) {
+    free(list_search_offset);
+    free(list_search_post);
+    free(list_search_hits);
+    list_search_offset = NULL;
+    list_search_post = NULL;
+    list_search_hits = NULL;
+    num_search_hits = -1;
+}
+
+static void
+list_presort_destroy(void) {
+    free(list_by_name);
+    free(list_by_region);
+    free(list_name_rank);
+    list_by_name = NULL;
+    list_by_region = NULL;
+    list_name_rank = NULL;
+}
+
+/* Once per load, names and regions never change afterwards */
+static void
+list_presort(void) {
+    const int num_games = num_items_BASE - 1;
+    list_index_destroy();
+    list_search_destroy();
+    list_presort_destroy();
+    if (num_games <= 0) {
+        return;
+    }
+    list_by_name = malloc(num_games * sizeof(gd_item*));
+    list_by_region = malloc(num_games * sizeof(gd_item*));
+    list_name_rank = malloc(num_items_BASE * sizeof(uint32_t));
+    list_name_key = malloc(num_items_BASE * sizeof(uint32_t));
+    if (!list_by_name || !list_by_region || !list_name_rank || !list_name_key) {
+        /* Views fall back to SD order */
+        printf("%s no free memory\n", __func__);
+        list_presort_destroy();
+        free(list_name_key);
+        list_name_key = NULL;
+        return;
+    }
+
+    for (int i = 0; i < num_items_BASE; i++) {
+        list_name_key[i] = list_collation_key(gd_slots_BASE[i].name);
+    }
+    for (int i = 0; i < num_games; i++) {
+        list_by_name[i] = list_by_region[i] = &gd_slots_BASE[i + 1];
+    }
+    qsort(list_by_name, num_games, sizeof(gd_item*), struct_cmp_by_name);
+    qsort(list_by_region, num_games, sizeof(gd_item*), struct_cmp_by_region);
+
+    list_name_rank[0] = 0;
+    for (int i = 0; i < num_games; i++) {
+        list_name_rank[list_by_name[i] - gd_slots_BASE] = (uint32_t)i;
+    }
+    free(list_name_key);
+    list_name_key = NULL;
+}
+
+static int
+struct_cmp_by_product(const void* a, const void* b) {
+    const gd_item* ia = *(const gd_item**)a;
+    const gd_item* ib = *(const gd_item**)b;
+    int cmp = strncmp(ia->product, ib->product, sizeof(ia->product));
+    if (!cmp) {
+        cmp = gd_item_disc_num(ia->disc) - gd_item_disc_num(ib->disc);
+    }
+    return cmp ? cmp : (int)ia->slot_num - (int)ib->slot_num;
+}
+
+static uint32_t
+list_product_fnv(const char* product_id) {
+    return list_pool_fnv(product_id, strnlen(product_id, sizeof(((gd_item*)0)->product)));
+}
+
+static void
+list_product_destroy(void) {
+    free(list_by_product);
+    free(list_product_hash);
+    list_by_product = NULL;
+    list_product_hash = NULL;
+    list_product_mask = 0;
+}
+
+/* Once per load, after the serial fixups since they rewrite product IDs */
+static void
+list_product_index(void) {
+    const int num_games = num_items_BASE - 1;
+    list_product_destroy();
+    if (num_games <= 0) {
+        return;
+    }
+    uint32_t size = 4;
+    while (size < (uint32_t)num_games * 2) {
+        size <<= 1;
+    }
+    list_by_product = malloc(num_games * sizeof(gd_item*));
+    list_product_hash = calloc(size, sizeof(list_product_set));
+    if (!list_by_product || !list_product_hash) {
+        /* Multidisc sets come up empty */
+        printf("%s no free memory\n", __func__);
+        list_product_destroy();
+        return;
+    }
+    list_product_mask = size - 1;
+
+    for (int i = 0; i < num_games; i++) {
+        list_by_product[i] = &gd_slots_BASE[i + 1];
+    }
+    qsort(list_by_product, num_games, sizeof(gd_item*), struct_cmp_by_product);
+
+    for (int first = 0, last; first < num_games; first = last) {
+        const char* product_id = list_by_product[first]->product;
+        for (last = first + 1; last < num_games; last++) {
+            if (strncmp(list_by_product[last]->product, product_id, sizeof(list_by_product[last]->product))) {
+                break;
+            }
+        }
+        uint32_t pos = list_product_fnv(product_id) & list_product_mask;
+        while (list_product_hash[pos].count) {
+            pos = (pos + 1) & list_product_mask;
+        }
+        list_product_hash[pos] = (list_product_set){(uint32_t)first, (uint32_t)(last - first)};
+        if (product_id[0] != '\0' && last - first > MULTIDISC_MAX_GAMES_PER_SET) {
+            printf("LIST:Multidisc set %.*s has %d discs, only the first %d are listed\n",
+                   (int)sizeof(list_by_product[first]->product), product_id, last - first,
+                   MULTIDISC_MAX_GAMES_PER_SET);
+        }
+    }
+}
+
+/* Every game with this product ID, or NULL if there are none */
+static gd_item**
+list_product_find(const char* product_id, int* count) {
+    *count = 0;
+    if (!list_product_hash) {
+        return NULL;
+    }
+    uint32_t pos = list_product_fnv(product_id) & list_product_mask;
+    while (list_product_hash[pos].count) {
+        gd_item** set = &list_by_product[list_product_hash[pos].first];
+        if (!strncmp((*set)->product, product_id, sizeof((*set)->product))) {
+            *count = (int)list_product_hash[pos].count;
+            return set;
+        }
+        pos = (pos + 1) & list_product_mask;
+    }
+    return NULL;
+}
+
+/* p-th game in name order, or in SD order if the presort failed */
+static gd_item*
+list_game_at(int p) {
+    return list_by_name ? list_by_name[p] : &gd_slots_BASE[p + 1];
+}
+
+static int
+list_game_pos(const gd_item* item) {
+    return list_name_rank ? (int)list_name_rank[item - gd_slots_BASE] : (int)(item - gd_slots_BASE) - 1;
+}
+
+static uint32_t*
+list_index_set(int set) {
+    return &list_index[set * list_index_words];
+}
+
+static int
+list_index_build(void) {
+    const int num_games = num_items_BASE - 1;
+    if (list_index) {
+        return 0;
+    }
+    if (num_games <= 0) {
+        return -1;
+    }
+    list_index_words = (num_games + 31) / 32;
+    list_index = calloc((size_t)LIST_INDEX_SETS * list_index_words, sizeof(uint32_t));
+    if (!list_index) {
+        printf("%s no free memory\n", __func__);
+        list_index_words = 0;
+        return -1;
+    }
+
+    for (int p = 0; p < num_games; p++) {
+        const gd_item* item = list_game_at(p);
+        const uint32_t bit = 1u << (p & 31);
+        const int word = p >> 5;
+
+        int genre = 0;
+#ifndef STANDALONE_BINARY
+        db_item* meta;
+        if (!db_get_meta(gd_item_meta_id(item), &meta)) {
+            genre = meta->genre;
+            for (int a = 0; a < 8; a++) {
+                if (meta->accessories & (1 << a)) {
+                    list_index_set(LIST_INDEX_ACCESSORY + a)[word] |= bit;
+                }
+            }
+            for (int n = 0; n < 4 && n < meta->num_players; n++) {
+                list_index_set(LIST_INDEX_PLAYERS + n)[word] |= bit;
+            }
+        }
+#endif
+        for (int g = 0; g < 16; g++) {
+            if (genre & (1 << g)) {
+                list_index_set(LIST_INDEX_GENRE + g)[word] |= bit;
+            }
+        }
+        if (!genre) {
+            list_index_set(LIST_INDEX_GENRE + 16)[word] |= bit;
+        }
+
+        if (!strcmp(item->region, "J")) {
+            list_index_set(LIST_INDEX_REGION + 0)[word] |= bit;
+        } else if (!strcmp(item->region, "U")) {
+            list_index_set(LIST_INDEX_REGION + 1)[word] |= bit;
+        } else if (!strcmp(item->region, "E")) {
+            list_index_set(LIST_INDEX_REGION + 2)[word] |= bit;
+        }
+        if (!strncmp(item->region, "JUE", 3)) {
+            list_index_set(LIST_INDEX_REGION + 3)[word] |= bit;
+        }
+
+        const int letter = toupper((unsigned char)item->name[0]);
+        if (letter >= 'A' && letter <= 'Z') {
+            list_index_set(LIST_INDEX_LETTER + (letter - '@'))[word] |= bit;
+        } else if (!isalpha((unsigned char)item->name[0])) {
+            list_index_set(LIST_INDEX_LETTER)[word] |= bit;
+        }
+
+        if (list_item_hidden(item, 1)) {
+            list_index_set(LIST_INDEX_HIDDEN)[word] |= bit;
+        }
+    }
+    return 0;
+}
+
+static void
+list_index_and(uint32_t* result, int set) {
+    const uint32_t* bits = list_index_set(set);
+    for (int w = 0; w < list_index_words; w++) {
+        result[w] &= bits[w];
+    }
+}
+
+/* Leaves the matching games in LIST_INDEX_RESULT, returns how many */
+static int
+list_index_query(const list_filter* filter) {
+    if (list_index_build()) {
+        return -1;
+    }
+    const int num_games = num_items_BASE - 1;
+    uint32_t* result = list_index_set(LIST_INDEX_RESULT);
+    memset(result, 0xFF, list_index_words * sizeof(uint32_t));
+    if (num_games & 31) {
+        result[list_index_words - 1] = (1u << (num_games & 31)) - 1;
+    }
+
+    if (filter->genre >= 0 && filter->genre < 17) {
+        list_index_and(result, LIST_INDEX_GENRE + filter->genre);
+    }
+    if (filter->region >= 0 && filter->region < 4) {
+        list_index_and(result, LIST_INDEX_REGION + filter->region);
+    }
+    if (filter->letter >= 0 && filter->letter < 27) {
+        list_index_and(result, LIST_INDEX_LETTER + filter->letter);
+    }
+    if (filter->accessory >= 0 && filter->accessory < 8) {
+        list_index_and(result, LIST_INDEX_ACCESSORY + filter->accessory);
+    }
+    if (filter->min_players > 0) {
+        list_index_and(result, LIST_INDEX_PLAYERS + (filter->min_players > 4 ? 3 : filter->min_players - 1));
+    }
+
+    const uint32_t* hidden = list_index_set(LIST_INDEX_HIDDEN);
+    const int hide_multidisc = list_hide_multidisc();
+    int count = 0;
+    for (int w = 0; w < list_index_words; w++) {
+        if (hide_multidisc) {
+            result[w] &= ~hidden[w];
+        }
+        count += __builtin_popcount(result[w]);
+    }
+    return count;
+}
+
+/* Appends the last query result to list_temp in name order */
+static int
+list_index_collect(int temp_idx) {
+    const uint32_t* result = list_index_set(LIST_INDEX_RESULT);
+    for (int w = 0; w < list_index_words; w++) {
+        uint32_t bits = result[w];
+        while (bits) {
+            list_temp[temp_idx++] = list_game_at((w << 5) + __builtin_ctz(bits));
+            bits &= bits - 1;
+        }
+    }
+    return temp_idx;
+}
+
+int
+list_filter_count(const list_filter* filter) {
+    return list_index_query(filter);
+}
+
+void
+list_set_filter(const list_filter* filter) {
+    num_items_temp = 0;
+    if (list_index_query(filter) >= 0) {
+        num_items_temp = list_index_collect(0);
+    }
+    list_current = list_temp;
+    list_gen++;
+    num_items_current = num_items_temp;
+}
+
+static uint32_t
+list_search_bucket(const char* window, int len) {
+    const unsigned char* c = (const unsigned char*)window;
+    if (len == 1) {
+        return c[0];
+    }
+    const uint32_t key = (c[0] << 16) | (c[1] << 8) | (len == 3 ? c[2] : 1u << 24);
+    return 256 + ((key * 2654435761u) >> 19); /* Top 13 bits, LIST_SEARCH_HASHED */
+}
+
+static int
+list_search_fold(const char* str, char* folded, int max) {
+    int len = 0;
+    while (str[len] && len < max - 1) {
+        folded[len] = (char)tolower((unsigned char)str[len]);
+        len++;
+    }
+    folded[len] = '\0';
+    return len;
+}
+
+/* Built by list_search_prepare when search opens, two passes over the names: count then place */
+static int
+list_search_build(void) {
+    const int num_games = num_items_BASE - 1;
+    if (list_search_offset) {
+        return 0;
+    }
+    /* Positions are 16 bit, bigger lists are searched by scanning */
+    if (num_games <= 0 || num_games > 0xFFFF) {
+        return -1;
+    }
+    uint32_t* seen = malloc(LIST_SEARCH_BUCKETS * sizeof(uint32_t));
+    list_search_offset = calloc(LIST_SEARCH_BUCKETS + 1, sizeof(uint32_t));
+    if (!seen || !list_search_offset) {
+        printf("%s no free memory\n", __func__);
+        free(seen);
+        list_search_destroy();
+        return -1;
+    }
+
+    char folded[GD_ITEM_MAX_name];
+    for (int pass = 0; pass < 2; pass++) {
+        memset(seen, 0xFF, LIST_SEARCH_BUCKETS * sizeof(uint32_t));
+        for (int p = 0; p < num_games; p++) {
+            const int len = list_search_fold(list_game_at(p)->name, folded, sizeof(folded));
+            for (int width = 1; width <= 3; width++) {
+                for (int i = 0; i + width <= len; i++) {
+                    const uint32_t bucket = list_search_bucket(&folded[i], width);
+                    if (seen[bucket] == (uint32_t)p) {
+                        continue;
+                    }
+                    seen[bucket] = (uint32_t)p;
+                    if (pass == 0) {
+                        list_search_offset[bucket + 1]++;
+                    } else {
+                        list_search_post[list_search_offset[bucket]++] = (uint16_t)p;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (int b = 0; b < LIST_SEARCH_BUCKETS; b++) {
+                list_search_offset[b + 1] += list_search_offset[b];
+            }
+            list_search_post = malloc((list_search_offset[LIST_SEARCH_BUCKETS] + 1) * sizeof(uint16_t));
+            if (!list_search_post) {
+                printf("%s no free memory\n", __func__);
+                free(seen);
+                list_search_destroy();
+                return -1;
+            }
+        }
+    }
+    /* Placing moved every start up to the next bucket */
+    memmove(&list_search_offset[1], &list_search_offset[0], LIST_SEARCH_BUCKETS * sizeof(uint32_t));
+    list_search_offset[0] = 0;
+    free(seen);
+    return 0;
+}
+
+/* Games under the rarest window of query, NULL to scan every game */
+static const uint16_t*
+list_search_rarest(const char* query, int len, int* count) {
+    const uint16_t* post = NULL;
+    *count = num_items_BASE - 1;
+    if (list_search_build()) {
+        return NULL;
+    }
+    const int width = len < 3 ? len : 3;
+    for (int i = 0; i + width <= len; i++) {
+        const uint32_t bucket = list_search_bucket(&query[i], width);
+        const int size = (int)(list_search_offset[bucket + 1] - list_search_offset[bucket]);
+        if (!post || size < *count) {
+            post = &list_search_post[list_search_offset[bucket]];
+            *count = size;
+        }
+    }
+    return post;
+}
+
+static int
+list_search_in(const char* name, const char* query, int len) {
+    for (; *name; name++) {
+        if (tolower((unsigned char)*name) == query[0] && !strncasecmp(name, query, len)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* First position in name order whose name compares at least (or above) query */
+static int
+list_search_bound(const char* query, int len, int above) {
+    int lo = 0, hi = num_items_BASE - 1;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        const int cmp = strncasecmp(list_by_name[mid]->name, query, len);
+        if (cmp < 0 || (above && cmp == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Names starting with query come first, then names containing it, each in name order */
+static int
+list_search_fresh(const char* query, int len, int hide_multidisc) {
+    int count, temp_idx = 0;
+    const uint16_t* post = list_search_rarest(query, len, &count);
+    /* A single char bucket holds exactly the names containing it */
+    const int exact = post && len == 1;
+
+    int lo = 0, hi = 0;
+    if (list_by_name) {
+        lo = list_search_bound(query, len, 0);
+        hi = list_search_bound(query, len, 1);
+    }
+    for (int p = lo; p < hi; p++) {
+        if (!list_item_hidden(list_by_name[p], hide_multidisc)) {
+            list_temp[temp_idx++] = list_by_name[p];
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        const int p = post ? post[i] : i;
+        if (p >= lo && p < hi) {
+            continue;
+        }
+        gd_item* item = list_game_at(p);
+        if (list_item_hidden(item, hide_multidisc) || (!exact && !list_search_in(item->name, query, len))) {
+            continue;
+        }
+        list_temp[temp_idx++] = item;
+    }
+    return temp_idx;
+}
+
+/* Contains query somewhere other than at the start */
+static int
+list_search_inside(const char* name, const char* query, int len) {
+    return strncasecmp(name, query, len) && list_search_in(name, query, len);
+}
+
+/* Query extends the last one, so only its matches can still match */
+static int
+list_search_refine(const char* query, int len) {
+    const int last_len = (int)strlen(list_search_query);
+    int temp_idx = 0, split = 0;
+
+    /* Only the last prefix group can start with query, already in name order */
+    while (split < num_search_hits && !strncasecmp(list_search_hits[split]->name, list_search_query, last_len)) {
+        if (!strncasecmp(list_search_hits[split]->name, query, len)) {
+            list_temp[temp_idx++] = list_search_hits[split];
+        }
+        split++;
+    }
+
+    /* What is left of both last groups is in name order, merged so typing history does not show */
+    int a = 0, b = split;
+    for (;;) {
+        while (a < split && !list_search_inside(list_search_hits[a]->name, query, len)) {
+            a++;
+        }
+        while (b < num_search_hits && !list_search_inside(list_search_hits[b]->name, query, len)) {
+            b++;
+        }
+        if (a == split && b == num_search_hits) {
+            break;
+        }
+        if (b == num_search_hits
+            || (a < split && list_game_pos(list_search_hits[a]) < list_game_pos(list_search_hits[b]))) {
+            list_temp[temp_idx++] = list_search_hits[a++];
+        } else {
+            list_temp[temp_idx++] = list_search_hits[b++];
+        }
+    }
+    return temp_idx;
+}
+
+int
+list_set_search(const char* query) {
+    const int num_games = num_items_BASE - 1;
+    const int hide_multidisc = list_hide_multidisc();
+    char folded[LIST_SEARCH_MAX];
+    const int len = list_search_fold(query, folded, sizeof(folded));
+
+    if (!len || num_games <= 0) {
+        num_search_hits = -1;
+        list_set_sort_alphabetical();
+        return num_items_current;
+    }
+    if (!list_search_hits) {
+        list_search_hits = malloc(num_games * sizeof(gd_item*));
+        if (!list_search_hits) {
+            printf("%s no free memory\n", __func__);
+            num_items_temp = num_items_current = 0;
+            list_current = list_temp;
+            list_gen++;
+            return 0;
+        }
+    }
+
+    int count;
+    int refine = num_search_hits >= 0 && hide_multidisc == list_search_hide
+                 && !strncmp(folded, list_search_query, strlen(list_search_query));
+    if (refine) {
+        /* After a broad query like "a", the rarest window can be fewer games than its matches */
+        list_search_rarest(folded, len, &count);
+        refine = num_search_hits <= count;
+    }
+    count = refine ? list_search_refine(folded, len) : list_search_fresh(folded, len, hide_multidisc);
+
+    /* A query nothing matches leaves the last results for list_search_restore */
+    if (count) {
+        memcpy(list_search_hits, list_temp, count * sizeof(gd_item*));
+        num_search_hits = count;
+        list_search_hide = hide_multidisc;
+        memcpy(list_search_query, folded, len + 1);
+    }
+
+    list_current = list_temp;
+    list_gen++;
+    num_items_temp = num_items_current = count;
+    return count;
+}
+
+void
+list_search_prepare(void) {
+    list_search_build();
+}
+
+int
+list_search_restore(const char* query) {
+    char folded[LIST_SEARCH_MAX];
+    list_search_fold(query, folded, sizeof(folded));
+    if (num_search_hits <= 0 || strcmp(folded, list_search_query) || list_hide_multidisc() != list_search_hide) {
+        return -1;
+    }
+    memcpy(list_temp, list_search_hits, num_search_hits * sizeof(gd_item*));
+    list_current = list_temp;
+    list_gen++;
+    num_items_temp = num_items_current = num_search_hits;
+    return num_search_hits;
 }
 
 void
 list_set_sort_name(void) {
     list_temp_reset();
     list_current = (gd_item**)list_alphabet;
+    list_gen++;
     num_items_current = num_items_alphabet;
 }
 
@@ -294,6 +1210,7 @@ void
 list_set_sort_region(void) {
     list_temp_reset();
     list_current = (gd_item**)list_region;
+    list_gen++;
     num_items_current = num_items_region;
 }
 
@@ -301,6 +1218,7 @@ void
 list_set_sort_genre(void) {
     list_temp_reset();
     list_current = (gd_item**)list_genre;
+    list_gen++;
     num_items_current = num_items_genre;
 }
 
@@ -308,79 +1226,37 @@ void
 list_set_sort_default(void) {
     list_temp_reset();
     list_current = list_temp;
+    list_gen++;
     num_items_current = num_items_temp;
 }
 
 void
 list_set_sort_alphabetical(void) {
-    list_temp_reset();
-    qsort(list_temp, num_items_temp, sizeof(gd_item*), struct_cmp_by_name);
+    list_temp_from(list_by_name);
     list_current = list_temp;
+    list_gen++;
     num_items_current = num_items_temp;
 }
 
 void
 list_set_sort_filter(const char type, int num) {
-#ifdef _arch_dreamcast
-    int base_idx, temp_idx = 1;
-    int hide_multidisc = sf_multidisc[0];
-
-    FLAGS_GENRE matching_genre = (1 << num);
+    list_filter filter = {-1, -1, -1, -1, 0};
+    switch (type) {
+        case 'G': filter.genre = num; break;
+        case 'R': filter.region = num; break;
+        default: filter.letter = num; break;
+    }
 
     list_temp[0] = &back_button;
     back_button.product[0] = type;
-
-    /* Skip openMenu itself */
-    for (base_idx = 1; base_idx < num_items_BASE; base_idx++) {
-        int disc_num = gd_item_disc_num(gd_slots_BASE[base_idx].disc);
-        int disc_set = gd_item_disc_total(gd_slots_BASE[base_idx].disc);
-        /* Only hide multi-disc entries if they have a valid product code */
-        if (hide_multidisc && disc_num > 1 && disc_set > 1 && gd_slots_BASE[base_idx].product[0] != '\0') {
-            continue;
-        }
-
-        gd_item* temp_item = &gd_slots_BASE[base_idx];
-        db_item* temp_meta;
-
-        switch (type) {
-            case 'G':
-                if (!db_get_meta(temp_item->product, &temp_meta)) {
-                    if (num == 16 && !temp_meta->genre) {
-                        list_temp[temp_idx++] = temp_item;
-                    } else if (temp_meta->genre & matching_genre) {
-                        list_temp[temp_idx++] = temp_item;
-                    }
-                } else if (num == 16) {
-                    list_temp[temp_idx++] = temp_item;
-                }
-                break;
-            case 'R':
-
-                if (num == 0 && !strcmp(temp_item->region, "J")) {
-                    list_temp[temp_idx++] = temp_item;
-                } else if (num == 1 && !strcmp(temp_item->region, "U")) {
-                    list_temp[temp_idx++] = temp_item;
-                } else if (num == 2 && !strcmp(temp_item->region, "E")) {
-                    list_temp[temp_idx++] = temp_item;
-                } else if (num == 3 && !strncmp(temp_item->region, "JUE", 3)) {
-                    list_temp[temp_idx++] = temp_item;
-                }
-                break;
-            default:
-                if (num != 0) {
-                    if (toupper(temp_item->name[0]) == (num + '@')) {
-                        list_temp[temp_idx++] = temp_item;
-                    }
-                } else if (!isalpha((int)temp_item->name[0])) {
-                    list_temp[temp_idx++] = temp_item;
-                }
-        }
+    num_items_temp = 1;
+    if (list_index_query(&filter) >= 0) {
+        num_items_temp = list_index_collect(1);
     }
 
-    qsort(&list_temp[1], temp_idx - 1, sizeof(gd_item*), struct_cmp_by_name);
     list_current = list_temp;
-    num_items_current = num_items_temp = temp_idx;
-#endif
+    list_gen++;
+    num_items_current = num_items_temp;
 }
 
 const struct gd_item**
@@ -393,201 +1269,341 @@ list_get_multidisc(void) {
     return (const gd_item**)list_multidisc;
 }
 
-void
-list_set_genre(int matching_genre) {
-#if !defined(STANDALONE_BINARY)
-    int base_idx, temp_idx = 0;
-
-    int hide_multidisc = sf_multidisc[0];
+/* Games with any genre in matching_genre, in a presorted order or SD order when NULL */
+static void
+list_genre_from(gd_item* const* order, int matching_genre) {
+    int temp_idx = 0;
 
-    /* Skip openMenu itself */
-    for (base_idx = 1; base_idx < num_items_BASE; base_idx++) {
-        int disc_num = gd_item_disc_num(gd_slots_BASE[base_idx].disc);
-        int disc_set = gd_item_disc_total(gd_slots_BASE[base_idx].disc);
-        /* Only hide multi-disc entries if they have a valid product code */
-        if (hide_multidisc && disc_num > 1 && disc_set > 1 && gd_slots_BASE[base_idx].product[0] != '\0') {
-            continue;
+    /* Union of the genre bitmaps, then each game is a single bit test */
+    if (!list_index_build()) {
+        uint32_t* result = list_index_set(LIST_INDEX_RESULT);
+        memset(result, 0, list_index_words * sizeof(uint32_t));
+        for (int g = 0; g < 16; g++) {
+            if (matching_genre & (1 << g)) {
+                const uint32_t* bits = list_index_set(LIST_INDEX_GENRE + g);
+                for (int w = 0; w < list_index_words; w++) {
+                    result[w] |= bits[w];
+                }
+            }
+        }
+        if (list_hide_multidisc()) {
+            const uint32_t* hidden = list_index_set(LIST_INDEX_HIDDEN);
+            for (int w = 0; w < list_index_words; w++) {
+                result[w] &= ~hidden[w];
+            }
         }
 
-        gd_item* temp_item = &gd_slots_BASE[base_idx];
-        db_item* temp_meta;
-        if (!db_get_meta(temp_item->product, &temp_meta)) {
-            if (temp_meta->genre & matching_genre) {
-                list_temp[temp_idx++] = temp_item;
+        if (order == list_by_name) {
+            temp_idx = list_index_collect(0);
+        } else {
+            /* Skip openMenu itself */
+            for (int idx = 0; idx < num_items_BASE - 1; idx++) {
+                gd_item* temp_item = order ? order[idx] : &gd_slots_BASE[idx + 1];
+                const int p = list_game_pos(temp_item);
+                if (result[p >> 5] & (1u << (p & 31))) {
+                    list_temp[temp_idx++] = temp_item;
+                }
             }
         }
     }
 
     num_items_temp = temp_idx;
-#endif
+}
+
+void
+list_set_genre(int matching_genre) {
+    list_genre_from(NULL, matching_genre);
 }
 
 void
 list_set_genre_sort(int genre, int sort) {
     FLAGS_GENRE matching_genre = (1 << genre);
-    list_set_genre(matching_genre);
 
     switch (sort) {
-        case 1: qsort(list_temp, num_items_temp, sizeof(gd_item*), struct_cmp_by_name); break;
-        case 2: qsort(list_temp, num_items_temp, sizeof(gd_item*), struct_cmp_by_region); break;
+        case 1: list_genre_from(list_by_name, matching_genre); break;
+        case 2: list_genre_from(list_by_region, matching_genre); break;
         default:
             /* @Note: no sort, strange codeflow */
+            list_genre_from(NULL, matching_genre);
             break;
     }
 
     list_current = list_temp;
+    list_gen++;
     num_items_current = num_items_temp;
 }
 
+/* Same folder, by pointer when both come from the string pool */
+static int
+list_same_folder(const gd_item* item, const char* folder_path) {
+    return !folder_path || item->folder == folder_path || !strcmp(item->folder, folder_path);
+}
+
 void
 list_set_multidisc(const char* product_id) {
-    int base_idx, temp_idx = 0;
-
-    /* Skip openMenu itself */
-    for (base_idx = 1; base_idx < num_items_BASE; base_idx++) {
-        if (strcmp(gd_slots_BASE[base_idx].product, product_id)) {
-            continue;
-        }
-
-        list_multidisc[temp_idx++] = &gd_slots_BASE[base_idx];
-    }
-    num_items_multidisc = temp_idx;
+    list_set_multidisc_filtered(product_id, NULL);
 }
 
 void
 list_set_multidisc_filtered(const char* product_id, const char* folder_path) {
-    int base_idx, temp_idx = 0;
+    int count, temp_idx = 0;
+    gd_item** set = list_product_find(product_id, &count);
 
-    /* Skip openMenu itself */
-    for (base_idx = 1; base_idx < num_items_BASE; base_idx++) {
-        /* Must match product ID */
-        if (strcmp(gd_slots_BASE[base_idx].product, product_id)) {
+    for (int i = 0; i < count; i++) {
+        if (!list_same_folder(set[i], folder_path)) {
             continue;
         }
-
-        /* If folder filter provided, must also match folder */
-        if (folder_path && strcmp(gd_slots_BASE[base_idx].folder, folder_path)) {
-            continue;
+        if (temp_idx == MULTIDISC_MAX_GAMES_PER_SET) {
+            /* Already reported when the index was built */
+            break;
         }
-
-        list_multidisc[temp_idx++] = &gd_slots_BASE[base_idx];
+        list_multidisc[temp_idx++] = set[i];
     }
     num_items_multidisc = temp_idx;
 }
 
 int
 list_count_multidisc_filtered(const char* product_id, const char* folder_path) {
-    int count = 0;
+    int count, matches = 0;
+    gd_item** set = list_product_find(product_id, &count);
+
+    if (!folder_path) {
+        return count;
+    }
+    for (int i = 0; i < count; i++) {
+        matches += list_same_folder(set[i], folder_path);
+    }
+    return matches;
+}
+
+int
+list_length(void) {
+    return num_items_current;
+}
+
+unsigned int
+list_generation(void) {
+    return list_gen;
+}
 
+int
+list_multidisc_length(void) {
+    return num_items_multidisc;
+}
+
+/* Sega serial fixes and the art and meta remaps, one pass over the slots with
+ * each item keeping what it resolved to */
+static void
+fix_sega_serials(void) {
     /* Skip openMenu itself */
     for (int base_idx = 1; base_idx < num_items_BASE; base_idx++) {
-        /* Must match product ID */
-        if (strcmp(gd_slots_BASE[base_idx].product, product_id)) {
-            continue;
-        }
+        gd_item* item = &gd_slots_BASE[base_idx];
 
-        /* If folder filter provided, must also match folder */
-        if (folder_path && strcmp(gd_slots_BASE[base_idx].folder, folder_path)) {
-            continue;
+        const char* fixed = serial_fix_product(item->product, item->date, item->name);
+        if (fixed != item->product) {
+            strncpy(item->product, fixed, sizeof(item->product) - 1);
         }
+        const char* art_id = serial_santize_art(item->product);
+        const char* meta_id = serial_santize_meta(item->product);
+        item->art_id = (art_id != item->product) ? art_id : NULL;
+        item->meta_id = (meta_id != item->product) ? meta_id : NULL;
+    }
+}
 
-        count++;
+/* Whole file with a newline and NUL added, NULL if it cant be read */
+static char*
+list_load_file(const char* filename, size_t* size) {
+#ifndef STANDALONE_BINARY
+    file_t fd = fs_open(filename, O_RDONLY);
+    if (fd == -1)
+#else
+    FILE* fd = fopen(filename, "rb");
+    if (!fd)
+#endif
+    {
+        return NULL;
     }
-    return count;
+
+    *size = filelength(fd);
+    char* buffer = malloc(*size + 2) /* adjust for adding newline at end always */;
+    if (!buffer) {
+        printf("%s no free memory\n", __func__);
+#ifndef STANDALONE_BINARY
+        fs_close(fd);
+#else
+        fclose(fd);
+#endif
+        return NULL;
+    }
+#ifndef STANDALONE_BINARY
+    fs_read(fd, buffer, *size);
+    fs_close(fd);
+#else
+    fread(buffer, *size, 1, fd);
+    fclose(fd);
+#endif
+    /* Add newline */
+    buffer[*size + 0] = '\n';
+    buffer[*size + 1] = '\0';
+    return buffer;
+}
+
+static int
+list_parse_ini(const char* ini_buffer, const char* filename) {
+    if (ini_parse_string(ini_buffer, read_openmenu_ini, NULL) < 0) {
+        printf("INI:Error Parsing %s!\n", filename);
+        fflush(stdout);
+        /*exit or something */
+        return -1;
+    }
+
+    printf("Info: Loaded %d items from %d\n", num_items_read, num_items_BASE);
+    /* Trim list if over reported */
+    if (num_items_read != num_items_BASE) {
+        num_items_BASE = num_items_read;
+        num_items_temp = num_items_read - 1;
+    }
+    return 0;
+}
+
+/* Common to the INI and LIST.BIN paths */
+static void
+list_read_done(void) {
+    fix_sega_serials();
+    list_presort();
+    list_product_index();
+
+    printf("INI:Parse success (%d items)!\n", num_items_BASE);
+    list_temp_reset();
+    fflush(stdout);
 }
 
-int
-list_length(void) {
-    return num_items_current;
+/* Copies one NUL terminated field out of a LIST.BIN record, clipped to its gd_item size.
+ * A field filled to the brim has no NUL, like vga[1] after the INI path */
+static const char*
+list_snapshot_field(const char* p, const char* end, char* field, size_t field_size) {
+    const char* nul = memchr(p, '\0', (size_t)(end - p));
+    if (!nul) {
+        return NULL;
+    }
+    size_t len = (size_t)(nul - p);
+    if (len > field_size) {
+        len = field_size;
+    }
+    memcpy(field, p, len);
+    if (len < field_size) {
+        field[len] = '\0';
+    }
+    return nul + 1;
 }
 
-int
-list_multidisc_length(void) {
-    return num_items_multidisc;
+/* Same for a pooled field, interned like the INI path does */
+static const char*
+list_snapshot_pool(const char* p, const char* end, const char** field, size_t field_size) {
+    const char* nul = memchr(p, '\0', (size_t)(end - p));
+    if (!nul) {
+        return NULL;
+    }
+    size_t len = (size_t)(nul - p);
+    if (len >= field_size) {
+        len = field_size - 1;
+    }
+    *field = list_pool_intern(p, len);
+    return nul + 1;
 }
 
-static void
-fix_sega_serials(void) {
-    /* fixing Sega serial issues... */
-
-    /* Skip openMenu itself */
-    for (int base_idx = 1; base_idx < num_items_BASE; base_idx++) {
-        gd_item* item = &gd_slots_BASE[base_idx];
+/* LIST.BIN records if it was made from exactly this INI, NULL otherwise */
+static char*
+list_load_snapshot(const char* snapshot, const char* ini_buffer, size_t ini_size, list_bin_header* header) {
+#ifndef STANDALONE_BINARY
+    file_t fd = fs_open(snapshot, O_RDONLY);
+    if (fd == -1)
+#else
+    FILE* fd = fopen(snapshot, "rb");
+    if (!fd)
+#endif
+    {
+        return NULL;
+    }
 
-        /* Fix Alone in the Dark (PAL) overlapping Alone in the Dark (USA) */
-        if (!strcmp(item->product, "T15117N") && !strcmp(item->date, "20010423")) {
-            strcpy(item->product, "T15112D05");
-        }
-        /* Fix Crazy Taxi (PAL) overlapping Crazy Taxi (USA) */
-        if (!strcmp(item->product, "MK51035") && !strcmp(item->date, "20000120")) {
-            strcpy(item->product, "MK5103550");
-        }
-        /* Fix Disney's Donald Duck: Goin' Quackers (USA) overlapping Disney's
-     * Donald Duck: Quack Attack (PAL) */
-        if (!strcmp(item->product, "T17714D50") && !strcmp(item->date, "20001116")) {
-            strcpy(item->product, "T17719N");
-        }
-        /* Fix Floigan Bros (PAL) overlapping Floigan Bros (USA) */
-        if (!strcmp(item->product, "MK51114") && !strcmp(item->date, "20010920")) {
-            strcpy(item->product, "MK5111450");
-        }
-        /* Fix Legacy of Kain: Soul Reaver (PAL) overlapping Legacy of Kain: Soul
-     * Reaver (USA) */
-        if (!strcmp(item->product, "T36802N") && !strcmp(item->date, "19991220")) {
-            strcpy(item->product, "T36803D05");
-        }
-        /* Fix NBA2K2 (PAL) overlapping NBA2K2 (USA) */
-        if (!strcmp(item->product, "MK51178") && !strcmp(item->date, "20011129")) {
-            strcpy(item->product, "MK5117850");
-        }
-        /* Fix NBA Showtime (PAL) overlapping 4 Wheel Thunder (PAL) */
-        if (!strcmp(item->product, "T9706D50") && !strcmp(item->date, "19991201")) {
-            strcpy(item->product, "T9705D50");
-        }
-        /* Fix Nightmare Creatures II (USA) overlapping Dancing Blade 2 (JAP) */
-        if (!strcmp(item->product, "T9504M") && !strcmp(item->date, "20000407")) {
-            strcpy(item->product, "T9504N");
-        }
-        /* Fix Plasma Sword (PAL) overlapping Street Fighter Alpha 3 (PAL) */
-        if (!strcmp(item->product, "T7005D") && !strcmp(item->date, "20000711")) {
-            strcpy(item->product, "T7003D");
-        }
-        /* Fix Skies of Arcadia (PAL) overlapping Skies of Arcadia (USA) */
-        if (!strcmp(item->product, "MK51052") && !strcmp(item->date, "20010306")) {
-            strcpy(item->product, "MK5105250");
-        }
-        /* Fix Spider-Man (PAL) overlapping Spider-Man (USA) */
-        if (!strcmp(item->product, "T13008N") && !strcmp(item->date, "20010402")) {
-            strcpy(item->product, "T13011D50");
-        }
-        /* Fix TNN Motorsports (USA) overlapping Metal Slug 6 (AW) */
-        if (!strcmp(item->product, "T0000M") && !strcmp(item->date, "19990813")) {
-            strcpy(item->product, "T13701N");
+    char* data = NULL;
+#ifndef STANDALONE_BINARY
+    const int header_ok = fs_read(fd, header, sizeof(*header)) == sizeof(*header);
+#else
+    const int header_ok = fread(header, sizeof(*header), 1, fd) == 1;
+#endif
+    if (!header_ok || memcmp(header->magic.rich.alpha, "LST", 3) || header->magic.rich.version != LIST_BIN_VERSION) {
+        printf("LIST:Ignoring %s, unknown format\n", snapshot);
+    } else if (header->ini_size != ini_size || header->ini_crc != crc32c(0, ini_buffer, ini_size)) {
+        printf("LIST:Ignoring %s, made from another INI\n", snapshot);
+    } else if (header->num_items && (data = malloc(header->data_size))) {
+        /* Every record in one read */
+#ifndef STANDALONE_BINARY
+        const int data_ok = fs_read(fd, data, header->data_size) == (ssize_t)header->data_size;
+#else
+        const int data_ok = fread(data, header->data_size, 1, fd) == 1;
+#endif
+        if (!data_ok) {
+            printf("LIST:Ignoring %s, truncated\n", snapshot);
+            free(data);
+            data = NULL;
         }
+    }
 
-        /* Fix Maximum Speed (AW) overlapping Dolphin Blue (AW) */
-        if (!strcmp(item->product, "T0006M") && !strcmp(item->date, "20030609")) {
-            strcpy(item->product, "T0010M");
-        }
+#ifndef STANDALONE_BINARY
+    fs_close(fd);
+#else
+    fclose(fd);
+#endif
+    return data;
+}
+
+static int
+list_decode_snapshot(const list_bin_header* header, const char* data, const char* snapshot) {
+    if (list_alloc_slots((int)header->num_items)) {
+        return -1;
+    }
 
-        /* Fix Fist of North Star (AW) overlapping Rumble Fish (AW) */
-        if (!strcmp(item->product, "T0009M") && strstr(item->name, "orth")) {
-            strcpy(item->product, "T0026M");
+    const char* p = data;
+    const char* end = data + header->data_size;
+    for (uint32_t i = 0; i < header->num_items && p; i++) {
+        gd_item* item = &gd_slots_BASE[i];
+        if (end - p < (ptrdiff_t)sizeof(uint32_t)) {
+            p = NULL;
+            break;
         }
+        uint32_t slot_num;
+        memcpy(&slot_num, p, sizeof(slot_num));
+        item->slot_num = slot_num;
+        p += sizeof(slot_num);
+#define CFG(s, n, default)                                                                                             \
+    if (p) {                                                                                                           \
+        p = list_snapshot_field(p, end, item->n, sizeof(item->n));                                                     \
+    }
+#define CFG_POOL(s, n, default)                                                                                        \
+    if (p) {                                                                                                           \
+        p = list_snapshot_pool(p, end, &item->n, GD_ITEM_MAX_##n);                                                     \
+    }
+#include "backend/gd_item.def"
     }
+    if (!p) {
+        printf("LIST:Ignoring %s, truncated\n", snapshot);
+        list_destroy();
+        return -1;
+    }
+
+    num_items_BASE = num_items_read = (int)header->num_items;
+    num_items_temp = num_items_BASE - 1;
+    printf("LIST:Loaded %d items from %s\n", num_items_BASE, snapshot);
+    return 0;
 }
 
 int
 list_read(const char* filename) {
     /* Always LD/cdrom */
-#ifndef STANDALONE_BINARY
-    file_t ini = fs_open(filename, O_RDONLY);
-    if (ini == -1)
-#else
-    FILE* ini = fopen(filename, "rb");
-    if (!ini)
-#endif
-    {
+    size_t ini_size;
+    char* ini_buffer = list_load_file(filename, &ini_size);
+    if (!ini_buffer) {
         printf("INI:Error opening %s!\n", filename);
         fflush(stdout);
         /*exit or something */
@@ -596,51 +1612,127 @@ list_read(const char* filename) {
 
     printf("INI:Open %s\n", filename);
 
-    size_t ini_size = filelength(ini);
-    char* ini_buffer = malloc(ini_size + 2) /* adjust for adding newline at end always */;
-    if (!ini_buffer) {
-        printf("%s no free memory\n", __func__);
+    const int ret = list_parse_ini(ini_buffer, filename);
+    free(ini_buffer);
+    if (ret) {
         return -1;
     }
-#ifndef STANDALONE_BINARY
-    fs_read(ini, ini_buffer, ini_size);
-    fs_close(ini);
-#else
-    fread(ini_buffer, ini_size, 1, ini);
-    fclose(ini);
-#endif
-    /* Add newline */
-    ini_buffer[ini_size + 0] = '\n';
-    ini_buffer[ini_size + 1] = '\0';
 
-    if (ini_parse_string(ini_buffer, read_openmenu_ini, NULL) < 0) {
-        printf("INI:Error Parsing %s!\n", filename);
+    list_read_done();
+    return 0;
+}
+
+int
+list_read_snapshot(const char* filename, const char* snapshot) {
+    size_t ini_size;
+    char* ini_buffer = list_load_file(filename, &ini_size);
+    if (!ini_buffer) {
+        printf("INI:Error opening %s!\n", filename);
         fflush(stdout);
-        /*exit or something */
         return -1;
     }
-    free(ini_buffer);
-
-    printf("Info: Loaded %d items from %d\n", num_items_read, num_items_BASE);
-    /* Trim list if over reported */
-    if (num_items_read != num_items_BASE) {
-        num_items_BASE = num_items_read;
-        num_items_temp = num_items_read - 1;
-    }
 
-    fix_sega_serials();
+    printf("INI:Open %s\n", filename);
 
-    printf("INI:Parse success (%d items)!\n", num_items_BASE);
-    list_temp_reset();
-    fflush(stdout);
+    /* The INI is already in memory, a stale or missing snapshot costs only the hash */
+    list_bin_header header;
+    char* data = list_load_snapshot(snapshot, ini_buffer, ini_size, &header);
+    int ret = (data && !list_decode_snapshot(&header, data, snapshot)) ? 0 : list_parse_ini(ini_buffer, filename);
+    free(data);
+    free(ini_buffer);
+    if (ret) {
+        return -1;
+    }
 
+    list_read_done();
     return 0;
 }
 
 int
 list_read_default(void) {
-    return list_read(PATH_PREFIX "OPENMENU.INI");
+    return list_read_snapshot(PATH_PREFIX "OPENMENU.INI", PATH_PREFIX "LIST.BIN");
+}
+
+#ifdef STANDALONE_BINARY
+int
+list_ini_handler(void* user, const char* section, const char* name, const char* value) {
+    return read_openmenu_ini(user, section, name, value);
+}
+
+static char*
+list_snapshot_put(char* p, const char* field, size_t field_size) {
+    const size_t len = strnlen(field, field_size);
+    memcpy(p, field, len);
+    p[len] = '\0';
+    return p + len + 1;
+}
+
+int
+list_write_snapshot(const char* filename, const char* snapshot) {
+    size_t ini_size;
+    char* ini_buffer = list_load_file(filename, &ini_size);
+    if (!ini_buffer) {
+        printf("INI:Error opening %s!\n", filename);
+        return -1;
+    }
+    const uint32_t ini_crc = crc32c(0, ini_buffer, ini_size);
+    const int parsed = list_parse_ini(ini_buffer, filename);
+    free(ini_buffer);
+    if (parsed || num_items_BASE <= 0) {
+        return -1;
+    }
+
+    /* Slots as parsed, serial fixups are applied again on every load */
+    size_t data_size = 0;
+    for (int i = 0; i < num_items_BASE; i++) {
+        const gd_item* item = &gd_slots_BASE[i];
+        data_size += sizeof(uint32_t);
+#define CFG(s, n, default)      data_size += strnlen(item->n, sizeof(item->n)) + 1;
+#define CFG_POOL(s, n, default) data_size += strlen(item->n) + 1;
+#include "backend/gd_item.def"
+    }
+    char* data = malloc(data_size);
+    if (!data) {
+        printf("%s no free memory\n", __func__);
+        return -1;
+    }
+    char* p = data;
+    for (int i = 0; i < num_items_BASE; i++) {
+        const gd_item* item = &gd_slots_BASE[i];
+        const uint32_t slot_num = item->slot_num;
+        memcpy(p, &slot_num, sizeof(slot_num));
+        p += sizeof(slot_num);
+#define CFG(s, n, default)      p = list_snapshot_put(p, item->n, sizeof(item->n));
+#define CFG_POOL(s, n, default) p = list_snapshot_put(p, item->n, GD_ITEM_MAX_##n);
+#include "backend/gd_item.def"
+    }
+
+    list_bin_header header;
+    memcpy(header.magic.rich.alpha, "LST", 3);
+    header.magic.rich.version = LIST_BIN_VERSION;
+    header.num_items = (uint32_t)num_items_BASE;
+    header.ini_size = (uint32_t)ini_size;
+    header.ini_crc = ini_crc;
+    header.data_size = (uint32_t)data_size;
+
+    FILE* fd = fopen(snapshot, "wb");
+    int ret = -1;
+    if (fd) {
+        ret = (fwrite(&header, sizeof(header), 1, fd) == 1 && fwrite(data, data_size, 1, fd) == 1) ? 0 : -1;
+        fclose(fd);
+    }
+    free(data);
+    if (ret) {
+        printf("LIST:Error writing %s!\n", snapshot);
+        return -1;
+    }
+    printf("LIST:Wrote %d items to %s (%zu bytes, INI %zu bytes)\n", num_items_BASE, snapshot,
+           sizeof(header) + data_size, ini_size);
+
+    list_read_done();
+    return 0;
 }
+#endif
 
 void
 list_destroy(void) {
@@ -650,6 +1742,11 @@ list_destroy(void) {
     free(list_temp);
     gd_slots_BASE = NULL;
     list_temp = NULL;
+    list_index_destroy();
+    list_search_destroy();
+    list_presort_destroy();
+    list_product_destroy();
+    list_pool_destroy();
 }
 
 const gd_item*
@@ -661,77 +1758,170 @@ list_item_get(int idx) {
     return NULL;
 }
 
-/* Folder navigation system functions */
+int
+list_slot_count(void) {
+    return gd_slots_BASE ? num_items_BASE + 1 : 0;
+}
 
-static int
-folder_parse_path(const char* folder_path, char segments[][256], int max_segments) {
-    if (!folder_path || folder_path[0] == '\0') {
-        return 0;
+const gd_item*
+list_slot_get(int idx) {
+    if ((idx >= 0) && (idx < list_slot_count())) {
+        return &gd_slots_BASE[idx];
+    }
+
+    return NULL;
+}
+
+int
+list_slot_index(const gd_item* item) {
+    if (gd_slots_BASE && (item >= gd_slots_BASE) && (item < gd_slots_BASE + list_slot_count())) {
+        return (int)(item - gd_slots_BASE);
     }
 
-    int segment_count = 0;
-    const char* start = folder_path;
-    const char* end;
+    return -1;
+}
+
+/* Folder navigation system functions */
+
+static size_t
+folder_hash_slot(const folder_node_t* parent, const char* name, size_t size) {
+    uint32_t h = (uint32_t)((uintptr_t)parent >> 2) * 2654435761u;
+    h ^= (uint32_t)(uintptr_t)name * 2246822519u;
+    h ^= h >> 15;
+    return h & (size - 1);
+}
+
+static folder_node_t*
+folder_hash_get(const folder_node_t* parent, const char* name) {
+    if (!folder_hash || !name) {
+        return NULL;
+    }
+    for (size_t h = folder_hash_slot(parent, name, folder_hash_size); folder_hash[h].name;
+         h = (h + 1) & (folder_hash_size - 1)) {
+        if (folder_hash[h].parent == parent && folder_hash[h].name == name) {
+            return folder_hash[h].node;
+        }
+    }
+    return NULL;
+}
 
-    while ((end = strchr(start, '\\')) != NULL && segment_count < max_segments) {
-        size_t len = end - start;
-        if (len > 0 && len < 256) {
-            memcpy(segments[segment_count], start, len);
-            segments[segment_count][len] = '\0';
-            segment_count++;
+static int
+folder_hash_put(const folder_node_t* parent, const char* name, folder_node_t* node) {
+    if ((folder_hash_count + 1) * 2 > folder_hash_size) {
+        const size_t size = folder_hash_size ? folder_hash_size * 2 : 256;
+        folder_hash_entry* hash = calloc(size, sizeof(folder_hash_entry));
+        if (!hash) {
+            return -1;
+        }
+        for (size_t i = 0; i < folder_hash_size; i++) {
+            if (folder_hash[i].name) {
+                size_t h = folder_hash_slot(folder_hash[i].parent, folder_hash[i].name, size);
+                while (hash[h].name) {
+                    h = (h + 1) & (size - 1);
+                }
+                hash[h] = folder_hash[i];
+            }
         }
-        start = end + 1;
+        free(folder_hash);
+        folder_hash = hash;
+        folder_hash_size = size;
     }
+    size_t h = folder_hash_slot(parent, name, folder_hash_size);
+    while (folder_hash[h].name) {
+        h = (h + 1) & (folder_hash_size - 1);
+    }
+    folder_hash[h] = (folder_hash_entry){parent, name, node};
+    folder_hash_count++;
+    return 0;
+}
 
-    if (*start && segment_count < max_segments) {
-        strncpy(segments[segment_count], start, 255);
-        segments[segment_count][255] = '\0';
-        segment_count++;
+/* Steps to the next '\\' separated segment of a folder path, skipping empty and
+ * oversized ones like the UI always has. The segment is interned when create is
+ * set, otherwise NULL if no folder has that name. Returns 0 at the end */
+static int
+folder_next_segment(const char** path, const char** segment, int create) {
+    while (**path) {
+        const char* start = *path;
+        const char* end = strchr(start, '\\');
+        size_t len = end ? (size_t)(end - start) : strlen(start);
+        *path = start + len + (end ? 1 : 0);
+        if (!len || (end && len >= 256)) {
+            continue;
+        }
+        if (len > 255) {
+            len = 255;
+        }
+        *segment = create ? list_pool_intern(start, len) : list_pool_find(start, len);
+        return 1;
     }
+    return 0;
+}
 
-    return segment_count;
+static int
+folder_add_game(folder_node_t* node, gd_item* item) {
+    if (node->num_games >= node->games_capacity) {
+        int new_capacity = node->games_capacity ? node->games_capacity * 2 : 4;
+        gd_item** new_games = realloc(node->games, new_capacity * sizeof(gd_item*));
+        if (!new_games) {
+            printf("Warning: Could not expand games array for folder '%s'\n", node->name);
+            return -1;
+        }
+        node->games = new_games;
+        node->games_capacity = new_capacity;
+    }
+    node->games[node->num_games++] = item;
+    return 0;
 }
 
+/* name must be interned */
 static folder_node_t*
 folder_find_or_create_node(folder_node_t* parent, const char* name, int slot_num) {
     if (!parent || !name) {
         return NULL;
     }
 
-    for (int i = 0; i < parent->num_children; i++) {
-        if (strcmp(parent->children[i]->name, name) == 0) {
-            return parent->children[i];
-        }
+    folder_node_t* node = folder_hash_get(parent, name);
+    if (node) {
+        return node;
     }
 
-    if (parent->num_children >= MAX_FOLDER_CHILDREN) {
-        return NULL;
+    if (parent->num_children >= parent->children_capacity) {
+        int new_capacity = parent->children_capacity ? parent->children_capacity * 2 : 4;
+        folder_node_t** new_children = realloc(parent->children, new_capacity * sizeof(folder_node_t*));
+        if (!new_children) {
+            return NULL;
+        }
+        parent->children = new_children;
+        parent->children_capacity = new_capacity;
     }
 
-    folder_node_t* node = calloc(1, sizeof(folder_node_t));
+    node = calloc(1, sizeof(folder_node_t));
     if (!node) {
         return NULL;
     }
-
-    strncpy(node->name, name, 255);
-    node->name[255] = '\0';
-    node->parent = parent;
-    node->first_seen_slot = slot_num;  /* Track when this folder was first seen */
-
-    /* Allocate initial capacity for games (start with 64, will grow as needed) */
-    node->games_capacity = 64;
-    node->games = malloc(node->games_capacity * sizeof(gd_item*));
-    if (!node->games) {
+    if (folder_hash_put(parent, name, node)) {
         free(node);
         return NULL;
     }
-    node->num_games = 0;
+
+    node->name = name;
+    /* Shown as "[name]", built once here instead of on every listing */
+    char label[GD_ITEM_MAX_name];
+    snprintf(label, sizeof(label), "[%s]", node->name);
+    node->label = list_pool_intern(label, strlen(label));
+    node->parent = parent;
+    node->first_seen_slot = slot_num;  /* Track when this folder was first seen */
 
     parent->children[parent->num_children++] = node;
 
     return node;
 }
 
+static folder_node_t*
+folder_find_child(folder_node_t* parent, const char* name) {
+    return folder_hash_get(parent, list_pool_find(name, strlen(name)));
+}
+
 static folder_node_t*
 folder_find_by_path(folder_node_t* root, const char* path) {
     if (!root) {
@@ -742,22 +1932,13 @@ folder_find_by_path(folder_node_t* root, const char* path) {
         return root;
     }
 
-    char segments[MAX_FOLDER_DEPTH][256];
-    int depth = folder_parse_path(path, segments, MAX_FOLDER_DEPTH);
-
     folder_node_t* current = root;
-    for (int d = 0; d < depth; d++) {
-        folder_node_t* found = NULL;
-        for (int i = 0; i < current->num_children; i++) {
-            if (strcmp(current->children[i]->name, segments[d]) == 0) {
-                found = current->children[i];
-                break;
-            }
-        }
-        if (!found) {
+    const char* segment;
+    for (int d = 0; d < MAX_FOLDER_DEPTH && folder_next_segment(&path, &segment, 0); d++) {
+        current = folder_hash_get(current, segment);
+        if (!current) {
             return NULL;
         }
-        current = found;
     }
 
     return current;
@@ -773,6 +1954,7 @@ folder_tree_destroy_recursive(folder_node_t* node) {
         folder_tree_destroy_recursive(node->children[i]);
     }
 
+    free(node->children);
     /* Free the dynamic games array */
     if (node->games) {
         free(node->games);
@@ -798,77 +1980,96 @@ folder_cmp(const void* a, const void* b) {
      * - SORT_DEFAULT (0) = Alphabetical (old default behavior)
      * - SORT_NAME (1) = SD Card Order
      * Sort by slot order when Sort = Name, otherwise alphabetically */
+#ifndef STANDALONE_BINARY
     if (sf_sort[0] == SORT_NAME) {
         return (*item_a)->slot_num - (*item_b)->slot_num;
     }
+#endif
+
+    /* Games already know their place in name order */
+    if (!is_dir_a && list_name_rank) {
+        const uint32_t rank_a = list_name_rank[*item_a - gd_slots_BASE];
+        const uint32_t rank_b = list_name_rank[*item_b - gd_slots_BASE];
+        return (rank_a > rank_b) - (rank_a < rank_b);
+    }
 
     return strcasecmp((*item_a)->name, (*item_b)->name);
 }
 
-/* Check if a game should be visible within a folder node.
+static int
+folder_cmp_disc(const void* a, const void* b) {
+    const gd_item* item_a = *(const gd_item**)a;
+    const gd_item* item_b = *(const gd_item**)b;
+    const int cmp = strcmp(item_a->product, item_b->product);
+    return cmp ? cmp : gd_item_disc_num(item_a->disc) - gd_item_disc_num(item_b->disc);
+}
+
+/* Marks which discs a collapsed set hides, then counts bottom-up. Once per tree.
  * When multidisc hiding is enabled, show only the lowest disc number for this product in this folder.
  * The grouping mode only affects launcher/details, not folder display - every folder shows its local games. */
-static int
-folder_game_visible(folder_node_t* node, gd_item* game, int hide_multidisc) {
-    if (!hide_multidisc) {
-        return 1;  /* Show all discs */
+static void
+folder_count_visible(folder_node_t* node) {
+    for (int hide = 0; hide < 2; hide++) {
+        node->visible_subfolders[hide] = 0;
+        node->visible_total[hide] = 0;
     }
-
-    /* Games without product codes are always visible (treat as single disc) */
-    if (game->product[0] == '\0') {
-        return 1;
+    for (int i = 0; i < node->num_children; i++) {
+        folder_node_t* child = node->children[i];
+        folder_count_visible(child);
+        for (int hide = 0; hide < 2; hide++) {
+            node->visible_subfolders[hide] += (child->visible_total[hide] > 0);
+            node->visible_total[hide] += child->visible_total[hide];
+        }
     }
 
-    int disc_num = gd_item_disc_num(game->disc);
-    int disc_set = gd_item_disc_total(game->disc);
-
-    if (disc_set <= 1) {
-        return 1;  /* Single disc game, always visible */
+    /* Games without product codes are always visible */
+    gd_item** discs = malloc((node->num_games ? node->num_games : 1) * sizeof(gd_item*));
+    int num_discs = 0;
+    for (int i = 0; discs && i < node->num_games; i++) {
+        if (node->games[i]->product[0] != '\0') {
+            discs[num_discs++] = node->games[i];
+        }
     }
 
-    /* Show only the lowest disc number for this product in this folder */
-    int lowest_disc = disc_num;
-    for (int i = 0; i < node->num_games; i++) {
-        gd_item* other = node->games[i];
-        if (strcmp(other->product, game->product) == 0) {
-            int other_disc = gd_item_disc_num(other->disc);
-            if (other_disc < lowest_disc) {
-                lowest_disc = other_disc;
-            }
+    /* Grouped by product, a disc of a set above the lowest of its group is hidden */
+    int num_hidden = 0;
+    if (num_discs > 1) {
+        qsort(discs, num_discs, sizeof(gd_item*), folder_cmp_disc);
+    }
+    for (int i = 0, lowest = 0; i < num_discs; i++) {
+        if (i == 0 || strcmp(discs[i]->product, discs[i - 1]->product)) {
+            lowest = gd_item_disc_num(discs[i]->disc);
+        }
+        if (gd_item_disc_num(discs[i]->disc) != lowest && gd_item_disc_total(discs[i]->disc) > 1) {
+            folder_disc_hidden[discs[i] - gd_slots_BASE] = 1;
+            num_hidden++;
         }
     }
+    free(discs);
 
-    return (disc_num == lowest_disc);
+    node->visible_games[0] = node->num_games;
+    node->visible_games[1] = node->num_games - num_hidden;
+    for (int hide = 0; hide < 2; hide++) {
+        node->visible_total[hide] += node->visible_games[hide];
+    }
 }
 
-/* Count visible games in a folder node (non-recursive, just this folder's games) */
+/* Check if a game should be visible within its folder node */
 static int
-folder_count_visible_games(folder_node_t* node, int hide_multidisc) {
-    int count = 0;
-    for (int i = 0; i < node->num_games; i++) {
-        if (folder_game_visible(node, node->games[i], hide_multidisc)) {
-            count++;
-        }
-    }
-    return count;
+folder_game_visible(const gd_item* game, int hide_multidisc) {
+    return !hide_multidisc || !folder_disc_hidden[game - gd_slots_BASE];
 }
 
-/* Recursively check if a folder has any visible content (games or non-empty subfolders) */
+/* Count visible games in a folder node (non-recursive, just this folder's games) */
 static int
-folder_has_visible_content(folder_node_t* node, int hide_multidisc) {
-    /* Check if this folder has visible games */
-    if (folder_count_visible_games(node, hide_multidisc) > 0) {
-        return 1;
-    }
-
-    /* Check if any subfolder has visible content */
-    for (int i = 0; i < node->num_children; i++) {
-        if (folder_has_visible_content(node->children[i], hide_multidisc)) {
-            return 1;
-        }
-    }
+folder_count_visible_games(const folder_node_t* node, int hide_multidisc) {
+    return node->visible_games[hide_multidisc ? 1 : 0];
+}
 
-    return 0;
+/* Check if a folder has any visible content (games or non-empty subfolders) */
+static int
+folder_has_visible_content(const folder_node_t* node, int hide_multidisc) {
+    return node->visible_total[hide_multidisc ? 1 : 0] > 0;
 }
 
 void
@@ -879,57 +2080,65 @@ list_folder_init(void) {
         return;
     }
 
-    strcpy(folder_tree_root->name, "<ROOT>");
-
-    /* Allocate initial capacity for root node's games */
-    folder_tree_root->games_capacity = 64;
-    folder_tree_root->games = malloc(folder_tree_root->games_capacity * sizeof(gd_item*));
-    if (!folder_tree_root->games) {
-        printf("Error: Could not allocate root games array\n");
+    folder_tree_root->name = "<ROOT>";
+    folder_disc_hidden = calloc(num_items_BASE > 0 ? num_items_BASE : 1, 1);
+    if (!folder_disc_hidden) {
+        printf("Error: Could not allocate folder visibility\n");
         free(folder_tree_root);
         folder_tree_root = NULL;
         return;
     }
-    folder_tree_root->num_games = 0;
 
     for (int i = 1; i < num_items_BASE; i++) {
         gd_item* item = &gd_slots_BASE[i];
 
-        char segments[MAX_FOLDER_DEPTH][256];
-        int depth = folder_parse_path(item->folder, segments, MAX_FOLDER_DEPTH);
-
-        folder_node_t* current = folder_tree_root;
-
-        for (int d = 0; d < depth; d++) {
-            current = folder_find_or_create_node(current, segments[d], i);
-            if (!current) {
-                break;
+        /* Folder paths are interned, so each distinct path is only walked once */
+        folder_node_t* current = folder_hash_get(NULL, item->folder);
+        if (!current) {
+            current = folder_tree_root;
+            const char* path = item->folder;
+            const char* segment;
+            for (int d = 0; current && d < MAX_FOLDER_DEPTH && folder_next_segment(&path, &segment, 1); d++) {
+                current = folder_find_or_create_node(current, segment, i);
+            }
+            if (current) {
+                folder_hash_put(NULL, item->folder, current);
             }
         }
 
         if (current) {
-            /* Grow the games array if needed */
-            if (current->num_games >= current->games_capacity) {
-                int new_capacity = current->games_capacity * 2;
-                gd_item** new_games = realloc(current->games, new_capacity * sizeof(gd_item*));
-                if (new_games) {
-                    current->games = new_games;
-                    current->games_capacity = new_capacity;
-                } else {
-                    printf("Warning: Could not expand games array for folder '%s'\n", current->name);
-                    continue;
-                }
-            }
-            current->games[current->num_games++] = item;
+            folder_add_game(current, item);
         }
     }
 
+    folder_count_visible(folder_tree_root);
+
     folder_state.depth = 0;
     folder_state.path[0] = '\0';
 
     printf("Info: Folder tree built successfully\n");
 }
 
+/* Room for count folder entries, only as many as fit when memory runs out */
+static int
+folder_items_reserve(int count) {
+    if (count <= folder_items_capacity) {
+        return count;
+    }
+    int new_capacity = folder_items_capacity ? folder_items_capacity : 64;
+    while (new_capacity < count) {
+        new_capacity *= 2;
+    }
+    gd_item* grown = realloc(folder_items, new_capacity * sizeof(gd_item));
+    if (!grown) {
+        printf("%s no free memory, listing %d of %d folders\n", __func__, folder_items_capacity, count);
+        return folder_items_capacity;
+    }
+    folder_items = grown;
+    folder_items_capacity = new_capacity;
+    return count;
+}
+
 void
 list_set_folder_root(void) {
     printf("list_set_folder_root: Starting\n");
@@ -950,9 +2159,10 @@ list_set_folder_root(void) {
 
     int temp_idx = 0;
     folder_items_count = 0;
+    const int max_folders = folder_items_reserve(folder_tree_root->num_children);
 
     for (int i = 0; i < folder_tree_root->num_children; i++) {
-        if (folder_items_count >= MAX_FOLDER_NODES) {
+        if (folder_items_count >= max_folders) {
             break;
         }
 
@@ -964,7 +2174,8 @@ list_set_folder_root(void) {
         gd_item* folder_entry = &folder_items[folder_items_count++];
         memset(folder_entry, 0, sizeof(gd_item));
 
-        snprintf(folder_entry->name, 128, "[%s]", folder_tree_root->children[i]->name);
+        folder_entry->name = folder_tree_root->children[i]->label;
+        folder_entry->folder = "";
         strcpy(folder_entry->disc, "DIR");
         folder_entry->product[0] = 'F';
         folder_entry->slot_num = folder_tree_root->children[i]->first_seen_slot;
@@ -975,7 +2186,7 @@ list_set_folder_root(void) {
     for (int i = 0; i < folder_tree_root->num_games; i++) {
         gd_item* game = folder_tree_root->games[i];
 
-        if (!folder_game_visible(folder_tree_root, game, hide_multidisc)) {
+        if (!folder_game_visible(game, hide_multidisc)) {
             continue;
         }
 
@@ -986,6 +2197,7 @@ list_set_folder_root(void) {
     qsort(list_temp, temp_idx, sizeof(gd_item*), folder_cmp);
 
     list_current = list_temp;
+    list_gen++;
     num_items_current = num_items_temp = temp_idx;
 
     folder_state.depth = 0;
@@ -1020,9 +2232,10 @@ list_set_folder_path(const char* path) {
     }
 
     folder_items_count = 0;
+    const int max_folders = folder_items_reserve(node->num_children);
 
     for (int i = 0; i < node->num_children; i++) {
-        if (folder_items_count >= MAX_FOLDER_NODES) {
+        if (folder_items_count >= max_folders) {
             break;
         }
 
@@ -1034,7 +2247,8 @@ list_set_folder_path(const char* path) {
         gd_item* folder_entry = &folder_items[folder_items_count++];
         memset(folder_entry, 0, sizeof(gd_item));
 
-        snprintf(folder_entry->name, 128, "[%s]", node->children[i]->name);
+        folder_entry->name = node->children[i]->label;
+        folder_entry->folder = "";
         strcpy(folder_entry->disc, "DIR");
         folder_entry->product[0] = 'F';
         folder_entry->slot_num = node->children[i]->first_seen_slot;
@@ -1045,7 +2259,7 @@ list_set_folder_path(const char* path) {
     for (int i = 0; i < node->num_games; i++) {
         gd_item* game = node->games[i];
 
-        if (!folder_game_visible(node, game, hide_multidisc)) {
+        if (!folder_game_visible(game, hide_multidisc)) {
             continue;
         }
 
@@ -1055,6 +2269,7 @@ list_set_folder_path(const char* path) {
     qsort(list_temp, temp_idx, sizeof(gd_item*), folder_cmp);
 
     list_current = list_temp;
+    list_gen++;
     num_items_current = num_items_temp = temp_idx;
 }
 
@@ -1070,13 +2285,7 @@ list_folder_enter(const char* folder_name, int cursor_pos) {
     }
 
     /* Find child folder by name */
-    folder_node_t* target_folder = NULL;
-    for (int i = 0; i < current_node->num_children; i++) {
-        if (strcmp(current_node->children[i]->name, folder_name) == 0) {
-            target_folder = current_node->children[i];
-            break;
-        }
-    }
+    folder_node_t* target_folder = folder_find_child(current_node, folder_name);
 
     if (!target_folder) {
         return;  /* Folder not found */
@@ -1118,26 +2327,17 @@ list_folder_get_stats(const char* folder_name, int* num_subfolders, int* num_gam
 #endif
 
     /* Find child folder by name */
-    for (int i = 0; i < current_node->num_children; i++) {
-        if (strcmp(current_node->children[i]->name, folder_name) == 0) {
-            folder_node_t* child = current_node->children[i];
-
-            /* Count visible subfolders */
-            int visible_subfolders = 0;
-            for (int j = 0; j < child->num_children; j++) {
-                if (folder_has_visible_content(child->children[j], hide_multidisc)) {
-                    visible_subfolders++;
-                }
-            }
-            *num_subfolders = visible_subfolders;
-
-            /* Count visible games */
-            *num_games = folder_count_visible_games(child, hide_multidisc);
-            return 0;
-        }
+    folder_node_t* child = folder_find_child(current_node, folder_name);
+    if (!child) {
+        return -1;  /* Folder not found */
     }
 
-    return -1;  /* Folder not found */
+    /* Count visible subfolders */
+    *num_subfolders = child->visible_subfolders[hide_multidisc ? 1 : 0];
+
+    /* Count visible games */
+    *num_games = folder_count_visible_games(child, hide_multidisc);
+    return 0;
 }
 
 int
@@ -1186,8 +2386,17 @@ list_folder_destroy(void) {
         folder_tree_destroy_recursive(folder_tree_root);
         folder_tree_root = NULL;
     }
+    free(folder_disc_hidden);
+    folder_disc_hidden = NULL;
+    free(folder_hash);
+    folder_hash = NULL;
+    folder_hash_size = 0;
+    folder_hash_count = 0;
 
     folder_state.depth = 0;
     folder_state.path[0] = '\0';
+    free(folder_items);
+    folder_items = NULL;
+    folder_items_capacity = 0;
     folder_items_count = 0;
 }
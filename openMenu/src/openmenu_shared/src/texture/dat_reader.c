@@ -11,10 +11,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <uthash.h>
 
 #include <backend/dat_format.h>
+#include <texture/crc32c.h>
+#include <texture/lz4_block.h>
 
 /* Define configure constants */
 /* only defined when building the binary tool */
@@ -28,10 +31,10 @@
 #define DBG_PRINT(...)
 #endif
 
-typedef struct bin_item_raw {
-    char ID[12];
-    uint32_t offset;
-} bin_item_raw;
+/* Host tools always want the ver4 checksums, the console only when verifying */
+#if defined(STANDALONE_BINARY) || defined(DAT_VERIFY)
+#define DAT_KEEP_CRC
+#endif
 
 int
 DAT_init(dat_file* bin) {
@@ -39,6 +42,88 @@ DAT_init(dat_file* bin) {
     return 0;
 }
 
+/* ver3 keeps its own table layout, read it and size the scratch buffer */
+static int
+DAT_load_packed(dat_file* bin, const char* filename_safe) {
+    bin->packed = malloc(bin->num_chunks * sizeof(bin_item_packed));
+    if (!bin->packed) {
+        printf("%s no free memory\n", __func__);
+        return 1;
+    }
+
+    const size_t table_size = bin->num_chunks * sizeof(bin_item_packed);
+#ifndef STANDALONE_BINARY
+    const size_t table_read = (size_t)fs_read(bin->handle, bin->packed, table_size);
+#else
+    const size_t table_read = fread(bin->packed, 1, table_size, bin->handle);
+#endif
+    if (table_read != table_size) {
+        printf("DAT:Error Truncated file table in %s!\n", filename_safe);
+        return 1;
+    }
+
+#ifdef DAT_KEEP_CRC
+    /* Checksums follow the table directly */
+    if (bin->version == DAT_VERSION_CHECKED && bin->num_chunks) {
+        const size_t crc_size = bin->num_chunks * sizeof(uint32_t);
+        bin->crc = malloc(crc_size);
+        if (!bin->crc) {
+            printf("%s no free memory\n", __func__);
+            return 1;
+        }
+#ifndef STANDALONE_BINARY
+        const size_t crc_read = (size_t)fs_read(bin->handle, bin->crc, crc_size);
+#else
+        const size_t crc_read = fread(bin->crc, 1, crc_size, bin->handle);
+#endif
+        if (crc_read != crc_size) {
+            printf("DAT:Error Truncated checksum table in %s!\n", filename_safe);
+            return 1;
+        }
+#ifdef DAT_VERIFY
+        bin->verified = calloc((bin->num_chunks + 7) / 8, 1);
+        if (!bin->verified) {
+            printf("%s no free memory\n", __func__);
+            return 1;
+        }
+#endif
+    }
+#endif
+
+    uint32_t first_offset = 0xFFFFFFFF;
+    uint32_t max_length = 0;
+    for (unsigned int i = 0; i < bin->num_chunks; i++) {
+        if (bin->packed[i].length > bin->chunk_size) {
+            printf("DAT:Error Oversized chunk %.12s in %s!\n", bin->packed[i].ID, filename_safe);
+            return 1;
+        }
+        if (bin->packed[i].offset < first_offset) {
+            first_offset = bin->packed[i].offset;
+        }
+        if (bin->packed[i].length < bin->chunk_size && bin->packed[i].length > max_length) {
+            max_length = bin->packed[i].length;
+        }
+    }
+
+    /* Only compressed chunks pass through here, stored ones are read directly */
+    if (max_length) {
+        bin->scratch = malloc(max_length);
+        if (!bin->scratch) {
+            printf("%s no free memory\n", __func__);
+            return 1;
+        }
+    }
+
+    if (bin->num_chunks) {
+#ifndef STANDALONE_BINARY
+        fs_seek(bin->handle, first_offset, SEEK_SET);
+#else
+        fseek(bin->handle, first_offset, SEEK_SET);
+#endif
+    }
+    return 0;
+}
+
 int
 DAT_load_parse(dat_file* bin, const char* path) {
 #ifndef STANDALONE_BINARY
@@ -75,7 +160,7 @@ DAT_load_parse(dat_file* bin, const char* path) {
 #else
     fread(&file_header, sizeof(bin_header), 1, bin_fd);
 #endif
-    if (file_header.magic.rich.version != 1) {
+    if (file_header.magic.rich.version < DAT_VERSION_HASHED || file_header.magic.rich.version > DAT_VERSION_CHECKED) {
         printf("DAT:Error Incorrect input file format!\n");
         return 1;
     }
@@ -83,75 +168,237 @@ DAT_load_parse(dat_file* bin, const char* path) {
     /* setup basic bin file info */
     bin->chunk_size = file_header.chunk_size;
     bin->num_chunks = file_header.num_chunks;
+    bin->version = file_header.magic.rich.version;
     bin->handle = bin_fd;
-    bin->items = malloc(bin->num_chunks * sizeof(bin_item));
-    if (!bin->items) {
+    bin->first_chunk = 0;
+    bin->index = NULL;
+    bin->items = NULL;
+    bin->hash = NULL;
+    bin->packed = NULL;
+    bin->scratch = NULL;
+    bin->crc = NULL;
+    bin->verified = NULL;
+    if (DAT_VERSION_IS_PACKED(bin->version)) {
+        return DAT_load_packed(bin, filename_safe);
+    }
+
+    bin->index = malloc(bin->num_chunks * sizeof(bin_item_raw));
+    if (!bin->index) {
         printf("%s no free memory\n", __func__);
         return 1;
     }
-    bin->hash = NULL;
 
-    /* Parse file table to Hash table */
-    for (unsigned int i = 0; i < file_header.num_chunks; i++) {
+    /* Sorted tables are searched in place, only ver1 needs a hash table */
+    if (bin->version == DAT_VERSION_HASHED) {
+        bin->items = malloc(bin->num_chunks * sizeof(bin_item));
+        if (!bin->items) {
+            printf("%s no free memory\n", __func__);
+            return 1;
+        }
+    }
+
+    /* Read the whole file table in one go, every read is a round trip on /cd/ */
+    const size_t table_size = bin->num_chunks * sizeof(bin_item_raw);
 #ifndef STANDALONE_BINARY
-        fs_read(bin->handle, &bin->items[i], sizeof(bin_item_raw));
+    const size_t table_read = (size_t)fs_read(bin->handle, bin->index, table_size);
 #else
-        fread(&bin->items[i], sizeof(bin_item_raw), 1, bin->handle);
+    const size_t table_read = fread(bin->index, 1, table_size, bin->handle);
 #endif
-        HASH_ADD_STR(bin->hash, ID, &bin->items[i]);
+    if (table_read != table_size) {
+        printf("DAT:Error Truncated file table in %s!\n", filename_safe);
+        return 1;
+    }
+
+    /* Index file table */
+    bin->first_chunk = 0xFFFFFFFF;
+    for (unsigned int i = 0; i < bin->num_chunks; i++) {
+        if (bin->index[i].offset < bin->first_chunk) {
+            bin->first_chunk = bin->index[i].offset;
+        }
+        /* Empty IDs are entries deleted by datpatch */
+        if (bin->items && bin->index[i].ID[0]) {
+            memcpy(&bin->items[i], &bin->index[i], sizeof(bin_item_raw));
+            HASH_ADD_STR(bin->hash, ID, &bin->items[i]);
+        }
+    }
+    if (!bin->num_chunks) {
+        bin->first_chunk = 0;
     }
 
     /* Leave our handle in a handy place in case we need to read after */
 #ifndef STANDALONE_BINARY
-    fs_seek(bin->handle, bin->items[0].offset * bin->chunk_size, SEEK_SET);
+    fs_seek(bin->handle, bin->first_chunk * bin->chunk_size, SEEK_SET);
 #else
-    fseek(bin->handle, bin->items[0].offset * bin->chunk_size, SEEK_SET);
+    fseek(bin->handle, bin->first_chunk * bin->chunk_size, SEEK_SET);
 #endif
     return 0;
 }
 
+void
+DAT_close(dat_file* bin) {
+    HASH_CLEAR(hh, bin->hash);
+    free(bin->items);
+    free(bin->index);
+    free(bin->packed);
+    free(bin->scratch);
+    free(bin->crc);
+    free(bin->verified);
+    /* version is only set once the handle belongs to us */
+    if (bin->version) {
+#ifndef STANDALONE_BINARY
+        fs_close(bin->handle);
+#else
+        fclose(bin->handle);
+#endif
+    }
+    DAT_init(bin);
+}
+
 void
 DAT_info(const dat_file* bin) {
     DBG_PRINT("DAT:Stats\nChunk Size: %u\nNum Chunks: %u\n\n", bin->chunk_size, bin->num_chunks);
+    if (DAT_VERSION_IS_PACKED(bin->version)) {
+        for (unsigned int i = 0; i < bin->num_chunks; i++) {
+            if (!bin->packed[i].ID[0]) {
+                continue;
+            }
+            DBG_PRINT("Record[%u] %s at 0x%X (%u bytes)\n", i, bin->packed[i].ID, (unsigned int)bin->packed[i].offset,
+                      (unsigned int)bin->packed[i].length);
+        }
+        DBG_PRINT("\n");
+        return;
+    }
     for (unsigned int i = 0; i < bin->num_chunks; i++) {
-        DBG_PRINT("Record[%u] %s at 0x%X\n", bin->items[i].offset, bin->items[i].ID,
-                  (unsigned int)(bin->items[i].offset * bin->chunk_size));
+        if (!bin->index[i].ID[0]) {
+            continue;
+        }
+        DBG_PRINT("Record[%u] %s at 0x%X\n", bin->index[i].offset, bin->index[i].ID,
+                  (unsigned int)(bin->index[i].offset * bin->chunk_size));
     }
     DBG_PRINT("\n");
 }
 
-uint32_t
-DAT_get_offset_by_ID(const dat_file* bin, const char* ID) {
-    const bin_item* item;
-    uint32_t ret;
+static int
+DAT_compare_ID(const char* a, const char* b) {
+    return strncmp(a, b, sizeof(((bin_item_raw*)0)->ID));
+}
+
+/* Every table entry type leads with its ID */
+static int
+DAT_compare_item(const void* a, const void* b) {
+    return DAT_compare_ID((const char*)a, (const char*)b);
+}
+
+void
+DAT_sort_index(bin_item_raw* items, uint32_t num_items) {
+    qsort(items, num_items, sizeof(bin_item_raw), DAT_compare_item);
+}
 
+void
+DAT_sort_packed_index(bin_item_packed* items, uint32_t num_items) {
+    qsort(items, num_items, sizeof(bin_item_packed), DAT_compare_item);
+}
+
+/* Binary search of a sorted on disk table */
+static uint32_t
+DAT_search_sorted(const void* table, size_t stride, uint32_t count, const char* ID) {
+    uint32_t low = 0;
+    uint32_t high = count;
+    while (low < high) {
+        const uint32_t mid = low + ((high - low) / 2);
+        const int cmp = DAT_compare_ID(ID, (const char*)table + (mid * stride));
+        if (cmp == 0) {
+            return mid;
+        }
+        if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return DAT_INDEX_NONE;
+}
+
+/* Returns the chunk index for ID or DAT_INDEX_NONE, table position for ver3 */
+static uint32_t
+DAT_find_chunk(const dat_file* bin, const char* ID) {
+    /* Entries deleted by datpatch keep their slot with an empty ID, never match them */
+    if (!ID[0]) {
+        return DAT_INDEX_NONE;
+    }
+    if (DAT_VERSION_IS_PACKED(bin->version)) {
+        return DAT_search_sorted(bin->packed, sizeof(bin_item_packed), bin->num_chunks, ID);
+    }
+    if (bin->version == DAT_VERSION_SORTED) {
+        const uint32_t pos = DAT_search_sorted(bin->index, sizeof(bin_item_raw), bin->num_chunks, ID);
+        return (pos != DAT_INDEX_NONE) ? bin->index[pos].offset : DAT_INDEX_NONE;
+    }
+
+    const bin_item* item;
     HASH_FIND_STR(bin->hash, ID, item);
-    if (item) {
-        ret = item->offset * bin->chunk_size;
-    } else {
-        ret = 0;
+    return item ? item->offset : DAT_INDEX_NONE;
+}
+
+/* Stored chunks are read straight into buf, compressed ones through scratch */
+static int
+DAT_read_packed(const dat_file* bin, uint32_t pos, void* buf) {
+    if (pos >= bin->num_chunks) {
+        return 0;
     }
+    const bin_item_packed* item = &bin->packed[pos];
+    const int stored = (item->length == bin->chunk_size);
+    void* dest = stored ? buf : bin->scratch;
 
-    return ret;
+#ifndef STANDALONE_BINARY
+    fs_seek(bin->handle, item->offset, SEEK_SET);
+    const size_t read = (size_t)fs_read(bin->handle, dest, item->length);
+#else
+    fseek(bin->handle, item->offset, SEEK_SET);
+    const size_t read = fread(dest, 1, item->length, bin->handle);
+#endif
+    if (read != item->length) {
+        return 0;
+    }
+#ifdef DAT_VERIFY
+    /* Debug builds check each chunk the first time it is loaded */
+    if (bin->crc && !(bin->verified[pos / 8] & (1 << (pos % 8)))) {
+        if (crc32c(0, dest, item->length) != bin->crc[pos]) {
+            printf("DAT:Error Checksum mismatch for chunk %.12s!\n", item->ID);
+            return 0;
+        }
+        bin->verified[pos / 8] |= (uint8_t)(1 << (pos % 8));
+    }
+#endif
+    if (stored) {
+        return 1;
+    }
+    if (lz4_block_decompress(bin->scratch, (int)item->length, buf, (int)bin->chunk_size) != (int)bin->chunk_size) {
+        printf("DAT:Error Corrupt chunk %.12s!\n", item->ID);
+        return 0;
+    }
+    return 1;
 }
 
 uint32_t
-DAT_get_index_by_ID(const dat_file* bin, const char* ID) {
-    const bin_item* item;
-    uint32_t ret;
-
-    HASH_FIND_STR(bin->hash, ID, item);
-    if (item) {
-        ret = item->offset;
-    } else {
-        ret = 0xFFFFFFFF;
+DAT_get_offset_by_ID(const dat_file* bin, const char* ID) {
+    const uint32_t chunk = DAT_find_chunk(bin, ID);
+    if (chunk == DAT_INDEX_NONE) {
+        return 0;
     }
+    return DAT_VERSION_IS_PACKED(bin->version) ? bin->packed[chunk].offset : chunk * bin->chunk_size;
+}
 
-    return ret;
+uint32_t
+DAT_get_index_by_ID(const dat_file* bin, const char* ID) {
+    return DAT_find_chunk(bin, ID);
 }
 
 int
 DAT_read_file_by_ID(const dat_file* bin, const char* ID, void* buf) {
+    if (DAT_VERSION_IS_PACKED(bin->version)) {
+        return DAT_read_packed(bin, DAT_find_chunk(bin, ID), buf);
+    }
+
     uint32_t offset = DAT_get_offset_by_ID(bin, ID);
     if (offset) {
 #ifndef STANDALONE_BINARY
@@ -168,6 +415,10 @@ DAT_read_file_by_ID(const dat_file* bin, const char* ID, void* buf) {
 
 int
 DAT_read_file_by_num(const dat_file* bin, uint32_t chunk_num, void* buf) {
+    if (DAT_VERSION_IS_PACKED(bin->version)) {
+        return DAT_read_packed(bin, chunk_num, buf);
+    }
+
     uint32_t offset = chunk_num * bin->chunk_size;
     if (chunk_num <= bin->num_chunks) {
 #ifndef STANDALONE_BINARY
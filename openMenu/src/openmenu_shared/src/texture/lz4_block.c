@@ -0,0 +1,260 @@
+/*
+ * File: lz4_block.c
+ * Project: texture
+ * File Created: Friday, 16th October 2026 1:05:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License,
+ * http://www.opensource.org/licenses/BSD-3-Clause
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <texture/lz4_block.h>
+
+#define LZ4_MIN_MATCH     (4)
+#define LZ4_LAST_LITERALS (5)  /* Block must end in at least this many literals */
+#define LZ4_MF_LIMIT      (12) /* Last match must start this far from the end */
+#define LZ4_MAX_OFFSET    (65535)
+#define LZ4_HASH_LOG      (15)
+#define LZ4_CHAIN_DEPTH   (64) /* Candidates tried per position, only the host tools compress */
+#define LZ4_NO_POS        (0xFFFFFFFF)
+
+static uint32_t
+lz4_read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t
+lz4_hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ4_HASH_LOG);
+}
+
+static uint8_t*
+lz4_write_length(uint8_t* op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+/* match_len of 0 writes the trailing literal only sequence */
+static uint8_t*
+lz4_write_sequence(uint8_t* op, const uint8_t* oend, const uint8_t* literals, size_t lit_len, uint32_t offset,
+                   size_t match_len) {
+    const size_t worst = 1 + (lit_len / 255 + 1) + lit_len + 2 + (match_len / 255 + 1);
+    if (worst > (size_t)(oend - op)) {
+        return NULL;
+    }
+
+    uint8_t* token = op++;
+    if (lit_len >= 15) {
+        *token = 15 << 4;
+        op = lz4_write_length(op, lit_len - 15);
+    } else {
+        *token = (uint8_t)(lit_len << 4);
+    }
+    memcpy(op, literals, lit_len);
+    op += lit_len;
+
+    if (match_len) {
+        const size_t extra = match_len - LZ4_MIN_MATCH;
+        *op++ = (uint8_t)(offset & 0xFF);
+        *op++ = (uint8_t)(offset >> 8);
+        if (extra >= 15) {
+            *token |= 15;
+            op = lz4_write_length(op, extra - 15);
+        } else {
+            *token |= (uint8_t)extra;
+        }
+    }
+    return op;
+}
+
+/* Hash chains over the 64KB window, most recent position first */
+typedef struct lz4_match_finder {
+    uint32_t* head;  /* Last position seen per hash, LZ4_NO_POS if none */
+    uint16_t* chain; /* Distance back to the previous position with the same hash, 0 ends */
+} lz4_match_finder;
+
+static void
+lz4_insert(lz4_match_finder* mf, const uint8_t* base, uint32_t pos) {
+    const uint32_t h = lz4_hash(lz4_read32(base + pos));
+    const uint32_t prev = mf->head[h];
+    const uint32_t delta = (prev == LZ4_NO_POS) ? 0 : pos - prev;
+    mf->chain[pos & LZ4_MAX_OFFSET] = (uint16_t)((delta > LZ4_MAX_OFFSET) ? 0 : delta);
+    mf->head[h] = pos;
+}
+
+/* Longest match for ip among the chained candidates, 0 if none reach LZ4_MIN_MATCH */
+static size_t
+lz4_find_match(const lz4_match_finder* mf, const uint8_t* base, const uint8_t* ip, const uint8_t* matchlimit,
+               const uint8_t** match) {
+    const uint32_t pos = (uint32_t)(ip - base);
+    const uint32_t seq = lz4_read32(ip);
+    uint32_t cand = mf->head[lz4_hash(seq)];
+    size_t best = 0;
+
+    for (int depth = LZ4_CHAIN_DEPTH; depth && cand != LZ4_NO_POS && (pos - cand) <= LZ4_MAX_OFFSET; depth--) {
+        const uint8_t* ref = base + cand;
+        if (lz4_read32(ref) == seq) {
+            const uint8_t* mp = ip + LZ4_MIN_MATCH;
+            const uint8_t* rp = ref + LZ4_MIN_MATCH;
+            while (mp < matchlimit && *mp == *rp) {
+                mp++;
+                rp++;
+            }
+            if ((size_t)(mp - ip) > best) {
+                best = (size_t)(mp - ip);
+                *match = ref;
+            }
+        }
+        const uint16_t delta = mf->chain[cand & LZ4_MAX_OFFSET];
+        if (!delta) {
+            break;
+        }
+        cand -= delta;
+    }
+    return best;
+}
+
+int
+lz4_block_compress(const void* src, int src_len, void* dst, int dst_cap) {
+    const uint8_t* const base = (const uint8_t*)src;
+    const uint8_t* const iend = base + src_len;
+    const uint8_t* ip = base;
+    const uint8_t* anchor = base;
+    uint8_t* op = (uint8_t*)dst;
+    const uint8_t* const oend = op + dst_cap;
+    lz4_match_finder mf;
+
+    mf.head = malloc(sizeof(uint32_t) << LZ4_HASH_LOG);
+    mf.chain = malloc(sizeof(uint16_t) * (LZ4_MAX_OFFSET + 1));
+    if (!mf.head || !mf.chain) {
+        free(mf.head);
+        free(mf.chain);
+        return 0;
+    }
+    memset(mf.head, 0xFF, sizeof(uint32_t) << LZ4_HASH_LOG);
+
+    if (src_len > LZ4_MF_LIMIT) {
+        const uint8_t* const mflimit = iend - LZ4_MF_LIMIT;
+        const uint8_t* const matchlimit = iend - LZ4_LAST_LITERALS;
+
+        while (ip < mflimit) {
+            const uint8_t* ref = NULL;
+            const size_t len = lz4_find_match(&mf, base, ip, matchlimit, &ref);
+            lz4_insert(&mf, base, (uint32_t)(ip - base));
+
+            if (!len) {
+                ip++;
+                continue;
+            }
+
+            op = lz4_write_sequence(op, oend, anchor, (size_t)(ip - anchor), (uint32_t)(ip - ref), len);
+            if (!op) {
+                break;
+            }
+            /* Keep the chains complete across the match */
+            const uint8_t* const mp = ip + len;
+            for (ip++; ip < mp; ip++) {
+                if (ip < mflimit) {
+                    lz4_insert(&mf, base, (uint32_t)(ip - base));
+                }
+            }
+            anchor = ip;
+        }
+    }
+
+    if (op) {
+        op = lz4_write_sequence(op, oend, anchor, (size_t)(iend - anchor), 0, 0);
+    }
+    free(mf.head);
+    free(mf.chain);
+    return op ? (int)(op - (uint8_t*)dst) : 0;
+}
+
+/* Reads a 255 terminated length run, returns 0 if it runs off the input */
+static int
+lz4_read_length(const uint8_t** ip, const uint8_t* iend, size_t* len) {
+    uint8_t b;
+    do {
+        if (*ip >= iend) {
+            return 0;
+        }
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return 1;
+}
+
+int
+lz4_block_decompress(const void* src, int src_len, void* dst, int dst_cap) {
+    const uint8_t* ip = (const uint8_t*)src;
+    const uint8_t* const iend = ip + src_len;
+    uint8_t* const base = (uint8_t*)dst;
+    uint8_t* op = base;
+    const uint8_t* const oend = base + dst_cap;
+
+    while (ip < iend) {
+        const uint8_t token = *ip++;
+
+        size_t len = token >> 4;
+        if (len == 15 && !lz4_read_length(&ip, iend, &len)) {
+            return -1;
+        }
+        if (len > (size_t)(iend - ip) || len > (size_t)(oend - op)) {
+            return -1;
+        }
+        memcpy(op, ip, len);
+        op += len;
+        ip += len;
+
+        /* Final sequence carries literals only */
+        if (ip >= iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - base)) {
+            return -1;
+        }
+
+        len = token & 15;
+        if (len == 15 && !lz4_read_length(&ip, iend, &len)) {
+            return -1;
+        }
+        len += LZ4_MIN_MATCH;
+        if (len > (size_t)(oend - op)) {
+            return -1;
+        }
+
+        const uint8_t* match = op - offset;
+        if (offset >= len) {
+            memcpy(op, match, len);
+            op += len;
+        } else {
+            /* Overlapping copy repeats the last offset bytes, the repeat doubles with each pass */
+            while (len) {
+                size_t step = (size_t)(op - match);
+                if (step > len) {
+                    step = len;
+                }
+                memcpy(op, match, step);
+                op += step;
+                len -= step;
+            }
+        }
+    }
+    return (int)(op - base);
+}
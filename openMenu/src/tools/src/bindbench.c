@@ -0,0 +1,273 @@
+/*
+ * File: bindbench.c
+ * Project: tools
+ * File Created: Friday, 16th October 2026 4:40:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <backend/gd_item.h>
+#include <backend/gd_list.h>
+
+#include "block_pool.h"
+#include "lru.h"
+#include "txr_binding.h"
+
+/* Called:
+./bindbench (frames) (games)
+
+Builds the 4x3 grid frame the way draw_grid_boxes does into a recording draw
+backend, over a synthetic OPENMENU.INI loaded with list_read. Holds on a page,
+scrolls a row now and then and switches between the default and alphabetical
+lists once in a while. Runs once looking every tile up every frame, then again
+through txr_binding. Covers upload at once into a 16 slot cache, one in eight
+games has none. Reports frame build time and cache lookups per frame.
+Returns 1 if the two runs ever record a different frame.
+*/
+
+#define BENCH_FILE  "bindbench.tmp"
+#define CACHE_SLOTS (16)
+#define SLOT_SIZE   (128 * 128 * 2)
+#define COLUMNS     (4)
+#define TILES       (12)
+#define MAX_DRAWS   (64)
+
+/* Just what draw_draw_image needs from it */
+typedef struct bench_image {
+  void *texture;
+  uint32_t width, height, format;
+} bench_image;
+
+/* One recorded draw_draw_image */
+typedef struct draw_cmd {
+  int x, y;
+  uint32_t color;
+  int32_t stamp; /* Item the texture was uploaded for, -1 for the missing icon */
+} draw_cmd;
+
+/* Where an item's art lives, as txr_resolve_list builds it */
+typedef struct bench_ref {
+  char key[LRU_KEY_LEN];
+} bench_ref;
+
+static block_pool pool;
+static cache_instance cache;
+static bench_ref *refs;
+static int32_t missing_icon = -1;
+static bench_image missing = {.texture = &missing_icon};
+
+static draw_cmd frame[MAX_DRAWS];
+static int num_draws;
+static unsigned long lookups, evictions;
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+static int write_synthetic_ini(const char *path, int games) {
+  FILE *fd = fopen(path, "wb");
+  if (!fd) {
+    return -1;
+  }
+  fprintf(fd, "[OPENMENU]\nnum_items=%d\n\n[ITEMS]\n01.name=openMenu\n01.product=NEODC_1\n", games + 1);
+  for (int i = 2; i <= games + 1; i++) {
+    /* Names out of slot order so the two lists differ */
+    fprintf(fd, "%02d.name=Game %05d\n%02d.product=T%05dN\n%02d.region=U\n%02d.disc=1/1\n", i,
+            (i * 7919) % games, i, i, i, i);
+  }
+  fclose(fd);
+  return 0;
+}
+
+static unsigned int pool_add_cb(const char *key, void *user) {
+  (void)key;
+  unsigned int slot;
+  void *ptr;
+  pool_get_next_free((block_pool *)user, &slot, &ptr);
+  return slot;
+}
+
+/* As block_pool_del_cb does it */
+static unsigned int pool_del_cb(const char *key, void *value, void *user) {
+  (void)key;
+  pool_dealloc_slot((block_pool *)user, *(unsigned int *)value);
+  txr_binding_invalidate();
+  evictions++;
+  return 0;
+}
+
+/* Recording backend for draw_draw_image */
+static void record_image(int x, int y, uint32_t color, const bench_image *img) {
+  if (num_draws < MAX_DRAWS) {
+    draw_cmd *cmd = &frame[num_draws++];
+    cmd->x = x;
+    cmd->y = y;
+    cmd->color = color;
+    memcpy(&cmd->stamp, img->texture, sizeof(cmd->stamp));
+  }
+}
+
+/* As txr_get_small_item does it once the cover is read, returns 0 */
+static int get_small_item(const gd_item *item, bench_image *img) {
+  const bench_ref *ref = &refs[list_slot_index(item)];
+  if (!ref->key[0]) {
+    *img = missing;
+    return 0;
+  }
+  lookups++;
+  int slot = find_in_cache(&cache, ref->key);
+  if (slot == -1) {
+    add_to_cache(&cache, ref->key, 0);
+    slot = find_in_cache(&cache, ref->key);
+    const int32_t stamp = list_slot_index(item);
+    memcpy(pool_get_slot_addr(&pool, slot), &stamp, sizeof(stamp));
+    pool_set_slot_format(&pool, slot, 128, 128, 1);
+  }
+  const slot_format *fmt = pool_get_slot_format(&pool, slot);
+  img->width = fmt->width;
+  img->height = fmt->height;
+  img->format = fmt->format;
+  img->texture = pool_get_slot_addr(&pool, slot);
+  return 0;
+}
+
+static bench_image txr_icon_list[TILES];
+static txr_binding icon_binding[TILES];
+
+/* As draw_grid_boxes does it */
+static void draw_grid_boxes(const gd_item **list_current, int list_len, int top, int bind) {
+  num_draws = 0;
+  for (int idx = 0; idx < TILES && top + idx < list_len; idx++) {
+    if (!bind) {
+      get_small_item(list_current[top + idx], &txr_icon_list[idx]);
+    } else if (!txr_binding_hit(&icon_binding[idx], top + idx)) {
+      if (!get_small_item(list_current[top + idx], &txr_icon_list[idx])) {
+        txr_binding_set(&icon_binding[idx], top + idx);
+      }
+    }
+    record_image(100 + (160 * (idx % COLUMNS)), 20 + (130 * (idx / COLUMNS)), 0xFFFFFFFF, &txr_icon_list[idx]);
+  }
+}
+
+static uint32_t frame_hash(void) {
+  uint32_t hash = 2166136261u;
+  const unsigned char *bytes = (const unsigned char *)frame;
+  for (size_t i = 0; i < num_draws * sizeof(draw_cmd); i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+typedef struct run_result {
+  double build_us;
+  unsigned long lookups, evictions, steady;
+} run_result;
+
+/* A row every 20 frames for a second, held for two, a list switch every 600 */
+static void run(int frames, int bind, uint32_t *hashes, run_result *result) {
+  int top = 0;
+  memset(result, 0, sizeof(run_result));
+  memset(icon_binding, 0, sizeof(icon_binding));
+  empty_cache(&cache);
+  pool_dealloc_all(&pool);
+  list_set_sort_default();
+  lookups = evictions = 0;
+
+  for (int f = 0; f < frames; f++) {
+    if (f % 600 == 599) {
+      (f / 600) % 2 ? list_set_sort_default() : list_set_sort_alphabetical();
+    }
+    const gd_item **list_current = list_get();
+    const int list_len = list_length();
+    if (f % 180 < 60 && f % 20 == 0) {
+      top = (top + COLUMNS) % (list_len - TILES);
+    }
+
+    const unsigned long before = lookups;
+    const double start = now_us();
+    draw_grid_boxes(list_current, list_len, top, bind);
+    result->build_us += now_us() - start;
+    result->steady += (lookups == before);
+    hashes[f] = frame_hash();
+  }
+  result->lookups = lookups;
+  result->evictions = evictions;
+}
+
+static void print_result(const char *name, const run_result *result, int frames) {
+  printf("%-10s %12.1f %14.2f %10lu %9.1f%%\n", name, result->build_us * 1000.0 / frames,
+         (double)result->lookups / frames, result->evictions, 100.0 * result->steady / frames);
+}
+
+int main(int argc, char **argv) {
+  int frames = 36000, games = 2000;
+  if (argc > 1) {
+    frames = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    games = atoi(argv[2]);
+  }
+  if (frames <= 0 || games <= TILES) {
+    printf("Incorrect usage!\n\t./bindbench (frames) (games)\n");
+    return 1;
+  }
+  if (write_synthetic_ini(BENCH_FILE, games) || list_read(BENCH_FILE)) {
+    printf("ERR: unable to write %s\n", BENCH_FILE);
+    return 1;
+  }
+  remove(BENCH_FILE);
+
+  /* The resolution table, one in eight has no art */
+  const int slots = list_slot_count();
+  refs = calloc(slots, sizeof(bench_ref));
+  uint32_t *plain = malloc(frames * sizeof(uint32_t));
+  uint32_t *bound = malloc(frames * sizeof(uint32_t));
+  void *vram = malloc(CACHE_SLOTS * SLOT_SIZE);
+  if (!refs || !plain || !bound || !vram) {
+    printf("ERR: no free memory!\n");
+    return 1;
+  }
+  for (int i = 0; i < slots; i++) {
+    if (i % 8) {
+      snprintf(refs[i].key, sizeof(refs[i].key), "IP%08X", (unsigned int)(i * 0x2000));
+    }
+  }
+
+  pool_create(&pool, vram, CACHE_SLOTS * SLOT_SIZE, CACHE_SLOTS);
+  cache_set_size(&cache, CACHE_SLOTS);
+  cache_callback_userdata(&cache, &pool);
+  cache_callback_add(&cache, pool_add_cb);
+  cache_callback_del(&cache, pool_del_cb);
+
+  run_result lookup, binding;
+  run(frames, 0, plain, &lookup);
+  run(frames, 1, bound, &binding);
+
+  int wrong = 0;
+  for (int f = 0; f < frames; f++) {
+    if (plain[f] != bound[f] && !wrong++) {
+      printf("ERR: frame %d drawn differently with bindings!\n", f);
+    }
+  }
+
+  printf("\n%d frames over %d games\n", frames, games);
+  printf("%-10s %12s %14s %10s %10s\n", "tiles", "build ns", "lookups/frame", "evictions", "no lookup");
+  print_result("lookup", &lookup, frames);
+  print_result("binding", &binding, frames);
+
+  empty_cache(&cache);
+  pool_destroy(&pool);
+  free(vram);
+  free(bound);
+  free(plain);
+  free(refs);
+  list_destroy();
+  return wrong ? 1 : EXIT_SUCCESS;
+}
@@ -10,12 +10,9 @@
 
 #pragma once
 
-#include <backend/dat_format.h>
+#include <stdio.h>
 
-typedef struct bin_item_raw {
-    char ID[12];
-    uint32_t offset;
-} bin_item_raw;
+#include <backend/dat_format.h>
 
 #if defined(WIN32) || defined(WINNT)
 #define PATH_SEP "\\"
@@ -24,6 +21,25 @@ typedef struct bin_item_raw {
 #endif
 
 void open_output(const char* path);
+/* Uppercased filename without extension, fills 12 bytes, -1 if the name is too long */
+int make_item_ID(const char* filename, char* ID);
 void write_bin_file(bin_header* file_header, bin_item_raw* bin_items, void* data_buf);
+/* Streaming writer: placeholder table, chunks appended as they arrive, table patched at the end */
+int begin_stream_file(bin_header* file_header, uint32_t max_items);
+int append_stream_chunk(bin_header* file_header, bin_item_raw* bin_items, const char* ID, const void* chunk);
+/* append_stream_chunk split in two, packing touches no shared state so it can run on any thread */
+uint32_t pack_stream_chunk(const bin_header* file_header, const void* chunk, void* scratch, const void** stored);
+int append_stream_stored(bin_header* file_header, bin_item_raw* bin_items, const char* ID, const void* stored,
+                         uint32_t length);
+/* Copies already stored bytes from another DAT as they are, without repacking them */
+int append_stream_copy(bin_header* file_header, bin_item_raw* bin_items, const char* ID, FILE* src, uint32_t src_offset,
+                       uint32_t length);
+void finish_stream_file(bin_header* file_header, bin_item_raw* bin_items);
+/* Bytes per item table entry on disk, including the ver4 checksum */
+size_t dat_entry_size(uint32_t version);
+/* Orders a ver4 item table like DAT_sort_packed_index, each checksum moving with its entry */
+int sort_checked_index(bin_item_packed* items, uint32_t* crcs, uint32_t num_items);
+/* Writes the ver4 checksums after a table of num_items entries */
+int write_checksum_table(FILE* fd, const uint32_t* crcs, uint32_t num_items);
 int iterate_dir(const char* path, int (*file_cb)(const char*, const char*, struct stat*), bin_header* file_header,
                 bin_item_raw** bin_items);
@@ -4,23 +4,34 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <uthash.h>
+
 #include "dat_packer_interface.h"
 #include <backend/dat_format.h>
+#include <texture/crc32c.h>
+#include <texture/lz4_block.h>
 
 static FILE *out_fd;
 
 void open_output(const char *path) {
-  out_fd = fopen(path, "wb");
+  /* Read back to confirm duplicate chunks */
+  out_fd = fopen(path, "w+b");
   if (!out_fd) {
     printf("ERR: unable to open %s for writing!\n", path);
   }
 }
 
 void write_bin_file(bin_header *file_header, bin_item_raw *bin_items, void *data_buf) {
+  /* Sorting only touches the item table, chunks stay where their offsets point */
+  if (file_header->magic.rich.version == DAT_VERSION_SORTED) {
+    DAT_sort_index(bin_items, file_header->num_chunks);
+  }
+
   printf("Writing:");
   /* Write header */
   printf("header..");
@@ -47,16 +58,378 @@ void write_bin_file(bin_header *file_header, bin_item_raw *bin_items, void *data
   printf("done!\n");
 }
 
+int make_item_ID(const char *filename, char *ID) {
+  /* Check if filename too long, dont try to reconcile, just skip */
+  const char *dot = strrchr(filename, '.');
+  if ((size_t)dot - (size_t)filename > 11) {
+    printf("Err: filename too long \"%s\", maxlength = 11!\n", filename);
+    return -1;
+  }
+
+  /* Use filename as ID, remove extension */
+  memset(ID, '\0', 12);
+  strncpy(ID, filename, 11);
+  char *end = strrchr(ID, '.');
+  if (end) {
+    const size_t nul_len = 12 - ((size_t)end - (size_t)ID);
+    memset(end, '\0', nul_len);
+  }
+  char *temp_start = ID;
+  while (*temp_start) {
+    *temp_start = toupper(*temp_start);
+    ++temp_start;
+  }
+  ID[11] = '\0';
+  ID[10] = '\0';
+  return 0;
+}
+
+/* Chunks already written, keyed by a hash of their stored bytes */
+typedef struct stream_chunk {
+  uint64_t hash;
+  uint32_t offset; /* Byte offset of the stored copy */
+  uint32_t length;
+  uint32_t crc;
+  UT_hash_handle hh;
+} stream_chunk;
+
+/* Input offsets already seen by append_stream_copy, and where their bytes went */
+typedef struct stream_source {
+  uint32_t src_offset;
+  uint32_t offset;
+  uint32_t crc;
+  UT_hash_handle hh;
+} stream_source;
+
+/* Streaming writer state, only one output is ever open */
+static bin_item_packed *stream_packed;
+static uint32_t *stream_crc; /* ver4 only, one per stream_packed entry */
+static unsigned char *stream_scratch;
+static unsigned char *stream_verify;
+static unsigned char *stream_copy_in; /* Chunk append_stream_copy reads, hashes and writes */
+static uint32_t stream_offset;
+static stream_chunk *stream_chunks;
+static uint32_t stream_duplicates;
+static stream_source *stream_sources;
+
+/* FNV-1a a word at a time, only has to narrow down candidates for the memcmp */
+static uint64_t hash_chunk(const void *data, uint32_t length) {
+  const unsigned char *p = data;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  uint32_t i = 0;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, p + i, sizeof(word));
+    hash ^= word;
+    hash *= 0x100000001b3ULL;
+  }
+  for (; i < length; i++) {
+    hash ^= p[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash ^ (hash >> 29);
+}
+
+/* Existing copy of these exact bytes in the output, or NULL */
+static const stream_chunk *find_duplicate(uint64_t hash, const void *stored, uint32_t length) {
+  stream_chunk *found;
+  HASH_FIND(hh, stream_chunks, &hash, sizeof(hash), found);
+  if (!found || found->length != length) {
+    return NULL;
+  }
+  fseek(out_fd, found->offset, SEEK_SET);
+  const size_t read = fread(stream_verify, length, 1, out_fd);
+  fseek(out_fd, 0, SEEK_END);
+  return (read == 1 && !memcmp(stream_verify, stored, length)) ? found : NULL;
+}
+
+size_t dat_entry_size(uint32_t version) {
+  if (version == DAT_VERSION_CHECKED) {
+    return sizeof(bin_item_packed) + sizeof(uint32_t);
+  }
+  return DAT_VERSION_IS_PACKED(version) ? sizeof(bin_item_packed) : sizeof(bin_item_raw);
+}
+
+/* A ver4 table entry with its checksum, so sorting keeps them together */
+typedef struct checked_item {
+  bin_item_packed item;
+  uint32_t crc;
+} checked_item;
+
+static int compare_checked_item(const void *a, const void *b) {
+  return strncmp(((const checked_item *)a)->item.ID, ((const checked_item *)b)->item.ID, sizeof(((bin_item_packed *)0)->ID));
+}
+
+int sort_checked_index(bin_item_packed *items, uint32_t *crcs, uint32_t num_items) {
+  checked_item *sorted = malloc((num_items + 1) * sizeof(checked_item));
+  if (!sorted) {
+    printf("ERR: no free memory!\n");
+    return -1;
+  }
+  for (uint32_t i = 0; i < num_items; i++) {
+    sorted[i] = (checked_item){items[i], crcs[i]};
+  }
+  qsort(sorted, num_items, sizeof(checked_item), compare_checked_item);
+  for (uint32_t i = 0; i < num_items; i++) {
+    items[i] = sorted[i].item;
+    crcs[i] = sorted[i].crc;
+  }
+  free(sorted);
+  return 0;
+}
+
+int write_checksum_table(FILE *fd, const uint32_t *crcs, uint32_t num_items) {
+  fseek(fd, sizeof(bin_header) + (num_items * sizeof(bin_item_packed)), SEEK_SET);
+  if (fwrite(crcs, sizeof(uint32_t), num_items, fd) != num_items) {
+    printf("ERR: unable to write checksums!\n");
+    return -1;
+  }
+  return 0;
+}
+
+int begin_stream_file(bin_header *file_header, uint32_t max_items) {
+  size_t table_size;
+  if (DAT_VERSION_IS_PACKED(file_header->magic.rich.version)) {
+    table_size = sizeof(bin_header) + (max_items * dat_entry_size(file_header->magic.rich.version));
+    file_header->padding0 = 0;
+    stream_packed = calloc(max_items, sizeof(bin_item_packed));
+    stream_scratch = malloc(file_header->chunk_size); /* Only used by append_stream_chunk */
+    if (file_header->magic.rich.version == DAT_VERSION_CHECKED) {
+      stream_crc = calloc(max_items + 1, sizeof(uint32_t));
+    }
+    if (!stream_packed || !stream_scratch || (file_header->magic.rich.version == DAT_VERSION_CHECKED && !stream_crc)) {
+      printf("ERR: no free memory!\n");
+      return -1;
+    }
+  } else {
+    /* Extra chunks the header and item table spill into, data starts after them */
+    file_header->padding0 = (sizeof(bin_header) + (max_items * sizeof(bin_item_raw))) / file_header->chunk_size;
+    table_size = (file_header->padding0 + 1) * file_header->chunk_size;
+  }
+  stream_offset = (uint32_t)table_size;
+  stream_chunks = NULL;
+  stream_duplicates = 0;
+  stream_verify = malloc(file_header->chunk_size);
+  if (!stream_verify) {
+    printf("ERR: no free memory!\n");
+    return -1;
+  }
+
+  /* Placeholder for the header and item table, patched by finish_stream_file */
+  char *nul = calloc(1, table_size);
+  if (!nul) {
+    printf("ERR: no free memory!\n");
+    return -1;
+  }
+  const size_t written = fwrite(nul, 1, table_size, out_fd);
+  free(nul);
+  return (written == table_size) ? 0 : -1;
+}
+
+uint32_t pack_stream_chunk(const bin_header *file_header, const void *chunk, void *scratch, const void **stored) {
+  *stored = chunk;
+  if (!DAT_VERSION_IS_PACKED(file_header->magic.rich.version)) {
+    return file_header->chunk_size;
+  }
+  /* Anything that does not shrink is kept as is */
+  const int packed_len = lz4_block_compress(chunk, file_header->chunk_size, scratch, file_header->chunk_size - 1);
+  if (!packed_len) {
+    return file_header->chunk_size;
+  }
+  *stored = scratch;
+  return (uint32_t)packed_len;
+}
+
+static void add_stream_entry(bin_header *file_header, bin_item_raw *bin_items, const char *ID, uint32_t offset, uint32_t length,
+                             uint32_t crc) {
+  const uint32_t num = file_header->num_chunks;
+  if (DAT_VERSION_IS_PACKED(file_header->magic.rich.version)) {
+    memcpy(stream_packed[num].ID, ID, sizeof(stream_packed[num].ID));
+    stream_packed[num].offset = offset;
+    stream_packed[num].length = length;
+  }
+  if (stream_crc) {
+    stream_crc[num] = crc;
+  }
+  memcpy(bin_items[num].ID, ID, sizeof(bin_items[num].ID));
+  bin_items[num].offset = offset / file_header->chunk_size;
+  file_header->num_chunks++;
+}
+
+static void add_stream_hash(uint64_t hash, uint32_t offset, uint32_t length, uint32_t crc) {
+  stream_chunk *chunk = malloc(sizeof(stream_chunk));
+  if (chunk) {
+    chunk->hash = hash;
+    chunk->offset = offset;
+    chunk->length = length;
+    chunk->crc = crc;
+    HASH_ADD(hh, stream_chunks, hash, sizeof(chunk->hash), chunk);
+  }
+}
+
+int append_stream_stored(bin_header *file_header, bin_item_raw *bin_items, const char *ID, const void *stored, uint32_t length) {
+  const uint64_t hash = hash_chunk(stored, length);
+  const stream_chunk *dup = find_duplicate(hash, stored, length);
+
+  /* Identical chunks are stored once, every ID just points at the same offset */
+  if (dup) {
+    add_stream_entry(file_header, bin_items, ID, dup->offset, length, dup->crc);
+    stream_duplicates++;
+    return 0;
+  }
+
+  /* ver4 checksums come from the bytes as they are written, nothing is read back */
+  const uint32_t crc = stream_crc ? crc32c(0, stored, length) : 0;
+  add_stream_entry(file_header, bin_items, ID, stream_offset, length, crc);
+  if (fwrite(stored, length, 1, out_fd) != 1) {
+    printf("ERR: write failed for %s!\n", ID);
+    return -1;
+  }
+  add_stream_hash(hash, stream_offset, length, crc);
+  stream_offset += length;
+  return 0;
+}
+
+int append_stream_copy(bin_header *file_header, bin_item_raw *bin_items, const char *ID, FILE *src, uint32_t src_offset, uint32_t length) {
+  /* Aliases in a deduplicated input are followed without reading the bytes again */
+  stream_source *source;
+  HASH_FIND(hh, stream_sources, &src_offset, sizeof(src_offset), source);
+  if (source) {
+    add_stream_entry(file_header, bin_items, ID, source->offset, length, source->crc);
+    stream_duplicates++;
+    return 0;
+  }
+
+  /* Anything else is read once, hashed and written from the same buffer */
+  if (!stream_copy_in && !(stream_copy_in = malloc(file_header->chunk_size))) {
+    printf("ERR: no free memory!\n");
+    return -1;
+  }
+  if (length > file_header->chunk_size || fseek(src, src_offset, SEEK_SET)
+      || fread(stream_copy_in, length, 1, src) != 1) {
+    printf("ERR: unable to read %s!\n", ID);
+    return -1;
+  }
+  const uint64_t hash = hash_chunk(stream_copy_in, length);
+  const stream_chunk *dup = find_duplicate(hash, stream_copy_in, length);
+  const uint32_t offset = dup ? dup->offset : stream_offset;
+  uint32_t crc = 0;
+  if (dup) {
+    crc = dup->crc;
+  } else if (stream_crc) {
+    crc = crc32c(0, stream_copy_in, length);
+  }
+
+  source = malloc(sizeof(stream_source));
+  if (source) {
+    source->src_offset = src_offset;
+    source->offset = offset;
+    source->crc = crc;
+    HASH_ADD(hh, stream_sources, src_offset, sizeof(source->src_offset), source);
+  }
+  add_stream_entry(file_header, bin_items, ID, offset, length, crc);
+  if (dup) {
+    stream_duplicates++;
+    return 0;
+  }
+  if (fwrite(stream_copy_in, length, 1, out_fd) != 1) {
+    printf("ERR: write failed for %s!\n", ID);
+    return -1;
+  }
+  add_stream_hash(hash, stream_offset, length, crc);
+  stream_offset += length;
+  return 0;
+}
+
+int append_stream_chunk(bin_header *file_header, bin_item_raw *bin_items, const char *ID, const void *chunk) {
+  const void *stored;
+  const uint32_t length = pack_stream_chunk(file_header, chunk, stream_scratch, &stored);
+  return append_stream_stored(file_header, bin_items, ID, stored, length);
+}
+
+void finish_stream_file(bin_header *file_header, bin_item_raw *bin_items) {
+  printf("Writing:");
+  printf("header..");
+  fseek(out_fd, 0, SEEK_SET);
+  fwrite(file_header, sizeof(bin_header), 1, out_fd);
+  printf("item list..");
+  /* Sorting only touches the item table, chunks stay where their offsets point */
+  if (DAT_VERSION_IS_PACKED(file_header->magic.rich.version)) {
+    if (stream_crc) {
+      sort_checked_index(stream_packed, stream_crc, file_header->num_chunks);
+    } else {
+      DAT_sort_packed_index(stream_packed, file_header->num_chunks);
+    }
+    fwrite(stream_packed, sizeof(bin_item_packed), file_header->num_chunks, out_fd);
+    printf("%u of %zu bytes..", stream_offset, (size_t)file_header->num_chunks * file_header->chunk_size);
+    if (stream_crc) {
+      printf("checksums..");
+      if (write_checksum_table(out_fd, stream_crc, file_header->num_chunks)) {
+        printf("ERR: output incomplete!\n");
+      }
+    }
+  } else {
+    if (file_header->magic.rich.version == DAT_VERSION_SORTED) {
+      DAT_sort_index(bin_items, file_header->num_chunks);
+    }
+    fwrite(bin_items, sizeof(bin_item_raw), file_header->num_chunks, out_fd);
+  }
+
+  if (stream_duplicates) {
+    printf("%u duplicates..", stream_duplicates);
+  }
+
+  fclose(out_fd);
+  stream_chunk *chunk, *tmp;
+  HASH_ITER(hh, stream_chunks, chunk, tmp) {
+    HASH_DEL(stream_chunks, chunk);
+    free(chunk);
+  }
+  stream_source *source, *source_tmp;
+  HASH_ITER(hh, stream_sources, source, source_tmp) {
+    HASH_DEL(stream_sources, source);
+    free(source);
+  }
+  free(stream_packed);
+  free(stream_crc);
+  free(stream_scratch);
+  free(stream_verify);
+  free(stream_copy_in);
+  stream_packed = NULL;
+  stream_crc = NULL;
+  stream_scratch = NULL;
+  stream_verify = NULL;
+  stream_copy_in = NULL;
+  printf("done!\n");
+}
+
 static int print_cb(const char *path, const char *folder, struct stat *statptr) {
   printf("%s\n", path);
   return 0;
 }
 
+typedef struct dir_entry {
+  char *name;
+  struct stat statbuf;
+} dir_entry;
+
+static int compare_dir_entry(const void *a, const void *b) {
+  return strcasecmp(((const dir_entry *)a)->name, ((const dir_entry *)b)->name);
+}
+
+static void free_dir_entries(dir_entry *entries, uint32_t num_entries) {
+  for (uint32_t i = 0; i < num_entries; i++) {
+    free(entries[i].name);
+  }
+  free(entries);
+}
+
 int iterate_dir(const char *path, int (*file_cb)(const char *, const char *, struct stat *), bin_header *file_header, bin_item_raw **bin_items) {
   struct dirent *dp;
-  struct stat statbuf;
   char pathbuf[FILENAME_MAX];
-  uint32_t num_files_found;
+  dir_entry *entries = NULL;
+  uint32_t num_files_found = 0;
+  uint32_t num_entries_alloc = 0;
 
   DIR *dir = opendir(path);
 
@@ -68,56 +441,48 @@ int iterate_dir(const char *path, int (*file_cb)(const char *, const char *, str
   if (!dir)
     return -1;
 
-  /* Loop twice, first time to count then second time to add */
-  num_files_found = 0;
+  /* One pass with one stat per entry, relative to the working directory */
   while ((dp = readdir(dir)) != NULL) {
     /* ignore these */
     if (strcmp(dp->d_name, ".") == 0 || strcmp(dp->d_name, "..") == 0)
       continue;
 
-    /* create proper full path */
-    getcwd(pathbuf, FILENAME_MAX);
-    strcat(pathbuf, PATH_SEP);
-    strcat(pathbuf, path);
-    strcat(pathbuf, PATH_SEP);
-    strcat(pathbuf, dp->d_name);
-    if (stat(pathbuf, &statbuf) == -1) {
+    snprintf(pathbuf, sizeof(pathbuf), "%s" PATH_SEP "%s", path, dp->d_name);
+    if (num_files_found == num_entries_alloc) {
+      num_entries_alloc = num_entries_alloc ? num_entries_alloc * 2 : 256;
+      dir_entry *grown = realloc(entries, num_entries_alloc * sizeof(dir_entry));
+      if (!grown) {
+        printf("ERR: no free memory!\n");
+        free_dir_entries(entries, num_files_found);
+        closedir(dir);
+        return -1;
+      }
+      entries = grown;
+    }
+    if (stat(pathbuf, &entries[num_files_found].statbuf) == -1) {
       printf("ERR: errno = %d\n", errno);
+      free_dir_entries(entries, num_files_found);
+      closedir(dir);
       return -1;
     }
 
     /* only check files */
-    if (S_ISREG(statbuf.st_mode)) {
+    if (S_ISREG(entries[num_files_found].statbuf.st_mode)) {
+      entries[num_files_found].name = strdup(dp->d_name);
       num_files_found++;
     }
   }
-  rewinddir(dir);
+  closedir(dir);
+
+  /* readdir order depends on the filesystem, visit files by name instead */
+  qsort(entries, num_files_found, sizeof(dir_entry), compare_dir_entry);
 
   file_header->padding0 = num_files_found;
   *bin_items = malloc(sizeof(bin_item_raw) * num_files_found);
 
-  while ((dp = readdir(dir)) != NULL) {
-    /* ignore these */
-    if (strcmp(dp->d_name, ".") == 0 || strcmp(dp->d_name, "..") == 0)
-      continue;
-
-    /* create proper full path */
-    getcwd(pathbuf, FILENAME_MAX);
-    strcat(pathbuf, PATH_SEP);
-    strcat(pathbuf, path);
-    strcat(pathbuf, PATH_SEP);
-    strcat(pathbuf, dp->d_name);
-    if (stat(pathbuf, &statbuf) == -1) {
-      printf("ERR: errno = %d\n", errno);
-      return -1;
-    }
-
-    /* only check files */
-    if (S_ISREG(statbuf.st_mode)) {
-      (*file_cb)(dp->d_name, path, &statbuf);
-    }
+  for (uint32_t i = 0; i < num_files_found; i++) {
+    (*file_cb)(entries[i].name, path, &entries[i].statbuf);
   }
-
-  closedir(dir);
+  free_dir_entries(entries, num_files_found);
   return 0;
-}
\ No newline at end of file
+}
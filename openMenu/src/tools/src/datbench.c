@@ -0,0 +1,314 @@
+/*
+ * File: datbench.c
+ * Project: tools
+ * File Created: Friday, 16th October 2026 10:12:00 am
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <uthash.h>
+
+#include <backend/dat_format.h>
+
+/* Called:
+./datbench (iterations) (cover.dat ...)
+
+Times DAT item table parsing on synthetic 500, 2000 and 10000 entry DATs.
+"per-entry" is the original loader: one unbuffered read per item, like
+fs_read on /cd/, then HASH_ADD_STR. "bulk" is DAT_load_parse, whose
+"DAT:Open" line is sent to /dev/null so console output is not timed.
+
+Any DATs given are read cover by cover through DAT_read_file_by_ID,
+reporting bytes pulled from the file and time per cover, so a plain and
+a -lz4 pack of the same folder can be compared.
+*/
+
+#define BENCH_CHUNK_SIZE (16)
+#define BENCH_FILE       "datbench.tmp"
+
+static const unsigned int bench_sizes[] = {500, 2000, 10000};
+
+typedef struct bench_result {
+  unsigned int num_items;
+  const char *loader;
+  double usec;
+  unsigned int reads;
+} bench_result;
+
+static bench_result results[3 * 3];
+static int num_results = 0;
+
+static void add_result(unsigned int num_items, const char *loader, double usec, unsigned int reads) {
+  results[num_results++] = (bench_result){num_items, loader, usec, reads};
+}
+
+typedef struct cover_result {
+  const char *path;
+  unsigned int version;
+  unsigned int num_items;
+  double bytes;
+  double usec;
+} cover_result;
+
+/* stdout is fully buffered, so a print while muted is only a copy into the buffer */
+static int console_fd = -1;
+static int null_fd = -1;
+
+static void mute_stdout(void) {
+  fflush(stdout);
+  dup2(null_fd, STDOUT_FILENO);
+}
+
+static void unmute_stdout(void) {
+  fflush(stdout);
+  dup2(console_fd, STDOUT_FILENO);
+}
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+static int write_synthetic_dat(const char *path, unsigned int num_items, int version) {
+  bin_header header;
+  bin_item_raw *items = calloc(num_items, sizeof(bin_item_raw));
+  if (!items) {
+    return -1;
+  }
+
+  /* Data begins after however many chunks the header and table need */
+  const uint32_t header_chunks = ((sizeof(bin_header) + num_items * sizeof(bin_item_raw)) / BENCH_CHUNK_SIZE) + 1;
+  for (unsigned int i = 0; i < num_items; i++) {
+    snprintf(items[i].ID, sizeof(items[i].ID), "T%07uN", i * 7919 % 10000000);
+    items[i].offset = header_chunks + i;
+  }
+
+  /* Scatter the table the way a directory walk would */
+  srand(1234);
+  for (unsigned int i = num_items - 1; i > 0; i--) {
+    unsigned int j = (unsigned int)rand() % (i + 1);
+    bin_item_raw tmp = items[i];
+    items[i] = items[j];
+    items[j] = tmp;
+  }
+  if (version == DAT_VERSION_SORTED) {
+    DAT_sort_index(items, num_items);
+  }
+
+  memcpy(&header.magic.rich.alpha, "DAT", 3);
+  header.magic.rich.version = version;
+  header.chunk_size = BENCH_CHUNK_SIZE;
+  header.num_chunks = num_items;
+  header.padding0 = 0;
+
+  FILE *fd = fopen(path, "wb");
+  if (!fd) {
+    free(items);
+    return -1;
+  }
+  fwrite(&header, sizeof(header), 1, fd);
+  fwrite(items, sizeof(bin_item_raw), num_items, fd);
+  /* Padding and chunk contents are never read, zeros are fine */
+  const size_t padding = ((header_chunks + num_items) * BENCH_CHUNK_SIZE) - (size_t)ftell(fd);
+  char *nul = calloc(1, padding);
+  fwrite(nul, padding, 1, fd);
+  fclose(fd);
+  free(nul);
+  free(items);
+  return 0;
+}
+
+/* Original loader, kept here only as the baseline to measure against */
+static int legacy_load_parse(dat_file *bin, const char *path, unsigned int *num_reads) {
+  bin_header header;
+  FILE *fd = fopen(path, "rb");
+  if (!fd) {
+    return 1;
+  }
+  setvbuf(fd, NULL, _IONBF, 0);
+
+  fread(&header, sizeof(bin_header), 1, fd);
+  *num_reads = 1;
+  bin->chunk_size = header.chunk_size;
+  bin->num_chunks = header.num_chunks;
+  bin->version = DAT_VERSION_HASHED;
+  bin->handle = fd;
+  bin->items = malloc(bin->num_chunks * sizeof(bin_item));
+  bin->hash = NULL;
+  for (unsigned int i = 0; i < header.num_chunks; i++) {
+    fread(&bin->items[i], sizeof(bin_item_raw), 1, fd);
+    (*num_reads)++;
+    HASH_ADD_STR(bin->hash, ID, &bin->items[i]);
+  }
+  return 0;
+}
+
+static int check_lookups(const dat_file *bin, unsigned int num_items) {
+  char id[12];
+  for (unsigned int i = 0; i < num_items; i++) {
+    snprintf(id, sizeof(id), "T%07uN", i * 7919 % 10000000);
+    if (DAT_get_index_by_ID(bin, id) == DAT_INDEX_NONE) {
+      printf("ERR: lost %s\n", id);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/* Bytes actually pulled from the file for one entry */
+static uint32_t stored_size(const dat_file *bin, unsigned int i) {
+  return DAT_VERSION_IS_PACKED(bin->version) ? bin->packed[i].length : bin->chunk_size;
+}
+
+static const char *entry_ID(const dat_file *bin, unsigned int i) {
+  return DAT_VERSION_IS_PACKED(bin->version) ? bin->packed[i].ID : bin->index[i].ID;
+}
+
+static int bench_covers(const char *path, int iterations, cover_result *result) {
+  dat_file bin;
+  DAT_init(&bin);
+  if (DAT_load_parse(&bin, path) || !bin.num_chunks) {
+    return -1;
+  }
+  void *buf = malloc(bin.chunk_size);
+  if (!buf) {
+    DAT_close(&bin);
+    return -1;
+  }
+  setvbuf(bin.handle, NULL, _IONBF, 0);
+
+  double bytes = 0;
+  double elapsed = 0;
+  double reads = 0;
+  for (int it = 0; it < iterations; it++) {
+    for (unsigned int i = 0; i < bin.num_chunks; i++) {
+      /* Entries deleted by datpatch keep an empty ID and cannot be read */
+      if (!entry_ID(&bin, i)[0]) {
+        continue;
+      }
+      const double start = now_us();
+      const int ret = DAT_read_file_by_ID(&bin, entry_ID(&bin, i), buf);
+      elapsed += now_us() - start;
+      if (!ret) {
+        printf("ERR: unable to read %.12s\n", entry_ID(&bin, i));
+        free(buf);
+        DAT_close(&bin);
+        return -1;
+      }
+      bytes += stored_size(&bin, i);
+      reads++;
+    }
+  }
+
+  const unsigned int live = (unsigned int)(reads / iterations);
+  if (!live) {
+    free(buf);
+    DAT_close(&bin);
+    return -1;
+  }
+  *result = (cover_result){path, bin.version, live, bytes / reads, elapsed / reads};
+  free(buf);
+  DAT_close(&bin);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int iterations = 50;
+  if (argc > 1) {
+    iterations = atoi(argv[1]);
+    if (iterations <= 0) {
+      printf("Incorrect usage!\n\t./datbench (iterations) (cover.dat ...)\n");
+      return 1;
+    }
+  }
+
+  setvbuf(stdout, NULL, _IOFBF, BUFSIZ);
+  console_fd = dup(STDOUT_FILENO);
+  null_fd = open("/dev/null", O_WRONLY);
+  if (console_fd < 0 || null_fd < 0) {
+    printf("ERR: unable to redirect stdout\n");
+    return 1;
+  }
+
+  for (size_t s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++) {
+    const unsigned int num_items = bench_sizes[s];
+    unsigned int num_reads = 0;
+    double start, elapsed;
+    dat_file bin;
+
+    /* per-entry reads, hashed */
+    write_synthetic_dat(BENCH_FILE, num_items, DAT_VERSION_HASHED);
+    elapsed = 0;
+    for (int i = 0; i < iterations; i++) {
+      DAT_init(&bin);
+      start = now_us();
+      legacy_load_parse(&bin, BENCH_FILE, &num_reads);
+      elapsed += now_us() - start;
+      if (i == 0 && check_lookups(&bin, num_items)) {
+        return 1;
+      }
+      DAT_close(&bin);
+    }
+    add_result(num_items, "per-entry", elapsed / iterations, num_reads);
+
+    /* bulk read, hashed */
+    elapsed = 0;
+    for (int i = 0; i < iterations; i++) {
+      DAT_init(&bin);
+      mute_stdout();
+      start = now_us();
+      DAT_load_parse(&bin, BENCH_FILE);
+      elapsed += now_us() - start;
+      unmute_stdout();
+      if (i == 0 && check_lookups(&bin, num_items)) {
+        return 1;
+      }
+      DAT_close(&bin);
+    }
+    add_result(num_items, "bulk v1", elapsed / iterations, 2);
+
+    /* bulk read, sorted table searched in place */
+    write_synthetic_dat(BENCH_FILE, num_items, DAT_VERSION_SORTED);
+    elapsed = 0;
+    for (int i = 0; i < iterations; i++) {
+      DAT_init(&bin);
+      mute_stdout();
+      start = now_us();
+      DAT_load_parse(&bin, BENCH_FILE);
+      elapsed += now_us() - start;
+      unmute_stdout();
+      if (i == 0 && check_lookups(&bin, num_items)) {
+        return 1;
+      }
+      DAT_close(&bin);
+    }
+    add_result(num_items, "bulk v2", elapsed / iterations, 2);
+  }
+
+  remove(BENCH_FILE);
+
+  printf("\n%8s  %-10s %12s %8s\n", "entries", "loader", "usec/load", "reads");
+  for (int i = 0; i < num_results; i++) {
+    printf("%8u  %-10s %12.1f %8u\n", results[i].num_items, results[i].loader, results[i].usec, results[i].reads);
+  }
+
+  if (argc > 2) {
+    printf("\n%-24s %4s %8s %14s %12s\n", "cover dat", "ver", "entries", "bytes/cover", "usec/cover");
+  }
+  for (int i = 2; i < argc; i++) {
+    cover_result cover;
+    if (bench_covers(argv[i], iterations, &cover)) {
+      printf("ERR: unable to bench %s\n", argv[i]);
+      return 1;
+    }
+    printf("%-24s %4u %8u %14.0f %12.1f\n", cover.path, cover.version, cover.num_items, cover.bytes, cover.usec);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*
+ * File: inibench.c
+ * Project: tools
+ * File Created: Friday, 16th October 2026 9:40:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include <ini.h>
+
+#include <backend/gd_item.h>
+#include <backend/gd_list.h>
+
+/* Called:
+./inibench (iterations) (slots)
+
+Writes a synthetic OPENMENU.INI with 5000 slots unless told otherwise and
+times parsing it with ini_parse_string. "tokenize" uses a handler that does
+nothing. "chain" is the original key handler, one strcasecmp pair per
+gd_item.def field. "table" is the hashed handler list_read uses, without the
+file read, fixups and list setup that follow it. The dispatch column takes
+the tokenize time off each, leaving just the key handling.
+*/
+
+#define BENCH_FILE "inibench.tmp"
+
+/* gd_item as the chain handler knew it, every field inline */
+typedef struct chain_item {
+  char name[128];
+  char date[12];
+  char product[12];
+  char disc[8];
+  char version[8];
+  char region[4];
+  unsigned int slot_num;
+  char vga[1];
+  char folder[512];
+  char type[8];
+} chain_item;
+
+static chain_item *chain_items;
+static int chain_num_items;
+static unsigned int num_keys;
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+static char *write_synthetic_ini(const char *path, int num_slots, size_t *size) {
+  static const char *regions[] = {"JUE", "U", "E", "J"};
+  const size_t capacity = (size_t)num_slots * 512 + 64;
+  char *ini = malloc(capacity);
+  if (!ini) {
+    return NULL;
+  }
+  size_t len = (size_t)snprintf(ini, capacity, "[OPENMENU]\nnum_items=%d\n\n[ITEMS]\n", num_slots);
+  num_keys = 1;
+  for (int i = 1; i <= num_slots; i++) {
+    len += (size_t)snprintf(ini + len, capacity - len,
+                            "%02d.name=Synthetic Game Number %d\n"
+                            "%02d.disc=%d/%d\n"
+                            "%02d.vga=1\n"
+                            "%02d.region=%s\n"
+                            "%02d.version=V1.%03d\n"
+                            "%02d.date=2000%02d%02d\n"
+                            "%02d.product=T%05dN\n"
+                            "%02d.folder=Genre %d/Series %d\n"
+                            "%02d.type=game\n",
+                            i, i, i, (i % 7) ? 1 : 2, (i % 7) ? 1 : 2, i, i, regions[i % 4], i, i % 1000, i,
+                            (i % 12) + 1, (i % 28) + 1, i, i, i, i % 17, i % 101, i);
+    num_keys += 9;
+  }
+
+  FILE *fd = fopen(path, "wb");
+  if (!fd) {
+    free(ini);
+    return NULL;
+  }
+  fwrite(ini, len, 1, fd);
+  fclose(fd);
+  *size = len;
+  return ini;
+}
+
+/* Original handler, kept here only as the baseline to measure against.
+ * slot_string grew from 4 to 8 bytes so 4 digit slots stay in bounds */
+static int chain_handler(void *user, const char *section, const char *name, const char *value) {
+  (void)user;
+
+  if ((strcmp(section, "OPENMENU") == 0) && (strcmp(name, "num_items") == 0)) {
+    chain_num_items = atoi(value);
+    free(chain_items);
+    chain_items = calloc(chain_num_items + 1, sizeof(chain_item));
+  } else {
+    char slot_string[8] = {0};
+    uintptr_t seperator = (uintptr_t)strchr(name, '.');
+    if (seperator) {
+      size_t temp_len = (size_t)(seperator - (uintptr_t)name);
+      memcpy(slot_string, name, temp_len);
+      int slot = atoi(slot_string);
+
+      chain_item *item = &chain_items[slot - 1];
+      if (!item->slot_num) {
+        item->slot_num = slot;
+      }
+
+      const char *plain_name = name + temp_len + 1;
+
+      if (0)
+        ;
+#define CFG(s, n, default) \
+  else if (strcasecmp(section, #s) == 0 && strcasecmp(plain_name, #n) == 0) strcpy(item->n, value);
+#include "backend/gd_item.def"
+    }
+  }
+  return 1;
+}
+
+static int null_handler(void *user, const char *section, const char *name, const char *value) {
+  (void)user;
+  (void)section;
+  (void)name;
+  (void)value;
+  return 1;
+}
+
+/* Both handlers must fill the same slots */
+static int check_items(void) {
+  list_set_sort_default();
+  for (int i = 0; i < list_length(); i++) {
+    const gd_item *item = list_item_get(i);
+    const chain_item *expected = &chain_items[item->slot_num - 1];
+#define CFG(s, n, default)                                            \
+  if (strncmp(item->n, expected->n, sizeof(expected->n))) {           \
+    printf("ERR: slot %u " #n " differs!\n", item->slot_num);         \
+    return -1;                                                        \
+  }
+#include "backend/gd_item.def"
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int iterations = 20;
+  int num_slots = 5000;
+  if (argc > 1) {
+    iterations = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    num_slots = atoi(argv[2]);
+  }
+  if (iterations <= 0 || num_slots <= 0) {
+    printf("Incorrect usage!\n\t./inibench (iterations) (slots)\n");
+    return 1;
+  }
+
+  size_t ini_size;
+  char *ini = write_synthetic_ini(BENCH_FILE, num_slots, &ini_size);
+  if (!ini) {
+    printf("ERR: unable to write %s\n", BENCH_FILE);
+    return 1;
+  }
+
+  /* Both handlers must agree before either is timed */
+  ini_parse_string(ini, chain_handler, NULL);
+  if (list_read(BENCH_FILE) || check_items()) {
+    return 1;
+  }
+  list_destroy();
+  remove(BENCH_FILE);
+
+  double start, tokenize = 0, chain = 0, table = 0;
+  for (int i = 0; i < iterations; i++) {
+    start = now_us();
+    ini_parse_string(ini, null_handler, NULL);
+    tokenize += now_us() - start;
+
+    start = now_us();
+    ini_parse_string(ini, chain_handler, NULL);
+    chain += now_us() - start;
+
+    start = now_us();
+    ini_parse_string(ini, list_ini_handler, NULL);
+    table += now_us() - start;
+    list_destroy();
+  }
+  tokenize /= iterations;
+  chain /= iterations;
+  table /= iterations;
+
+  printf("\n%u keys, %zu bytes, %d iterations\n", num_keys, ini_size, iterations);
+  printf("%-10s %12s %14s %14s\n", "handler", "usec/parse", "keys/sec", "dispatch k/s");
+  printf("%-10s %12.1f %14.0f %14s\n", "tokenize", tokenize, num_keys / tokenize * 1e6, "-");
+  printf("%-10s %12.1f %14.0f %14.0f\n", "chain", chain, num_keys / chain * 1e6, num_keys / (chain - tokenize) * 1e6);
+  printf("%-10s %12.1f %14.0f %14.0f\n", "table", table, num_keys / table * 1e6, num_keys / (table - tokenize) * 1e6);
+
+  free(chain_items);
+  free(ini);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+/*
+ * File: listpacker.c
+ * Project: tools
+ * File Created: Friday, 16th October 2026 7:25:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <backend/gd_item.h>
+#include <backend/gd_list.h>
+
+/* Called:
+./listpack OPENMENU.INI LIST.BIN
+
+Parses the menu ini and writes LIST.BIN beside it, which openMenu loads
+instead of parsing the ini for as long as the ini is unchanged
+The result is read back through the console loader and compared slot by slot
+*/
+
+#define NUM_ARGS (2)
+
+static int same_item(const gd_item *a, const gd_item *b) {
+  if (a->slot_num != b->slot_num) {
+    return 0;
+  }
+#define CFG(s, n, default)                 \
+  if (strncmp(a->n, b->n, sizeof(a->n))) { \
+    return 0;                              \
+  }
+#define CFG_POOL(s, n, default) \
+  if (strcmp(a->n, b->n)) {     \
+    return 0;                   \
+  }
+#include <backend/gd_item.def>
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  if (argc < NUM_ARGS + 1 /*binary itself*/) {
+    printf("Incorrect usage!\n\t./listpack OPENMENU.INI LIST.BIN\n");
+    return 1;
+  }
+
+  if (list_write_snapshot(argv[1], argv[2])) {
+    return 1;
+  }
+  list_set_sort_default();
+  const int len = list_length();
+  gd_item *parsed = malloc(sizeof(gd_item) * (len > 0 ? len : 1));
+  if (!parsed) {
+    printf("ERR: no free memory!\n");
+    return 1;
+  }
+  for (int i = 0; i < len; i++) {
+    /* Pooled strings go away with the list, keep copies */
+    memcpy(&parsed[i], list_item_get(i), sizeof(gd_item));
+#define CFG(s, n, default)
+#define CFG_POOL(s, n, default) parsed[i].n = strdup(parsed[i].n);
+#include <backend/gd_item.def>
+  }
+  list_destroy();
+
+  /* Same path the menu takes at boot */
+  if (list_read_snapshot(argv[1], argv[2])) {
+    return 1;
+  }
+  list_set_sort_default();
+  if (list_length() != len) {
+    printf("ERR: read back %d items, expected %d!\n", list_length(), len);
+    return 1;
+  }
+  for (int i = 0; i < len; i++) {
+    if (!same_item(&parsed[i], list_item_get(i))) {
+      printf("ERR: slot %u differs on read back!\n", parsed[i].slot_num);
+      return 1;
+    }
+  }
+  printf("Verified %d items\n", len);
+  for (int i = 0; i < len; i++) {
+#define CFG(s, n, default)
+#define CFG_POOL(s, n, default) free((char *)parsed[i].n);
+#include <backend/gd_item.def>
+  }
+  free(parsed);
+  list_destroy();
+
+  return EXIT_SUCCESS;
+}
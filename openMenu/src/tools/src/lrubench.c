@@ -0,0 +1,219 @@
+/*
+ * File: lrubench.c
+ * Project: tools
+ * File Created: Friday, 16th October 2026 11:55:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "block_pool.h"
+#include "lru.h"
+
+/* Called:
+./lrubench (frames)
+
+Drives the texture cache the way the grid menu does: 12 tiles looked up every
+frame from a 16 entry cache over a 16 slot block_pool, scrolling a row now and
+then and jumping somewhere else once in a while. Every answer is checked
+against a plain timestamp LRU, and every malloc, calloc, realloc, strdup and
+free made while the frames run is counted, linked with -Wl,--wrap.
+Returns 1 if any answer is wrong or the steady state touched the heap.
+*/
+
+#define NUM_GAMES    (2000)
+#define CACHE_SLOTS  (16)
+#define TILES        (12)
+#define ROW          (4)
+#define SLOT_SIZE    (128 * 128 * 2)
+#define NO_SLOT      (0xFFFFFFFF)
+
+/* Heap calls made while counting */
+static int counting;
+static unsigned int heap_calls;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+char *__real_strdup(const char *s);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+  heap_calls += counting;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size) {
+  heap_calls += counting;
+  return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  heap_calls += counting;
+  return __real_realloc(ptr, size);
+}
+
+char *__wrap_strdup(const char *s) {
+  heap_calls += counting;
+  return __real_strdup(s);
+}
+
+void __wrap_free(void *ptr) {
+  heap_calls += (counting && ptr);
+  __real_free(ptr);
+}
+
+/* The reference, what was used last and which pool slot it holds */
+typedef struct model_entry {
+  char key[16];
+  unsigned int slot;
+  unsigned long used;
+} model_entry;
+
+static model_entry model[CACHE_SLOTS];
+static int model_count;
+static unsigned long model_clock;
+
+static block_pool pool;
+static cache_instance cache;
+static unsigned int evictions;
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+static unsigned int pool_add_cb(const char *key, void *user) {
+  (void)key;
+  unsigned int slot;
+  void *ptr;
+  pool_get_next_free((block_pool *)user, &slot, &ptr);
+  return slot;
+}
+
+static unsigned int pool_del_cb(const char *key, void *value, void *user) {
+  (void)key;
+  pool_dealloc_slot((block_pool *)user, *(unsigned int *)value);
+  evictions++;
+  return 0;
+}
+
+/* Same lookup against the reference, returns the slot it expects */
+static unsigned int model_get(const char *key, int *hit) {
+  model_clock++;
+  for (int i = 0; i < model_count; i++) {
+    if (!strcmp(model[i].key, key)) {
+      model[i].used = model_clock;
+      *hit = 1;
+      return model[i].slot;
+    }
+  }
+  *hit = 0;
+  int victim = model_count;
+  if (model_count == CACHE_SLOTS) {
+    victim = 0;
+    for (int i = 1; i < model_count; i++) {
+      if (model[i].used < model[victim].used) {
+        victim = i;
+      }
+    }
+  } else {
+    model_count++;
+    model[victim].slot = NO_SLOT;
+  }
+  /* The pool hands out the lowest free slot, which is the one just freed */
+  unsigned int slot = model[victim].slot;
+  if (slot == NO_SLOT) {
+    int used[CACHE_SLOTS] = {0};
+    for (int i = 0; i < model_count; i++) {
+      if (i != victim && model[i].slot != NO_SLOT) {
+        used[model[i].slot] = 1;
+      }
+    }
+    for (slot = 0; used[slot]; slot++) {
+    }
+  }
+  snprintf(model[victim].key, sizeof(model[victim].key), "%s", key);
+  model[victim].slot = slot;
+  model[victim].used = model_clock;
+  return slot;
+}
+
+/* As txr_get_from_dat_set does it */
+static int cache_get(const char *key) {
+  int slot = find_in_cache(&cache, key);
+  if (slot == -1) {
+    add_to_cache(&cache, key, 0);
+    slot = find_in_cache(&cache, key);
+  }
+  return slot;
+}
+
+int main(int argc, char **argv) {
+  int frames = 200000;
+  if (argc > 1) {
+    frames = atoi(argv[1]);
+  }
+  if (frames <= 0) {
+    printf("Incorrect usage!\n\t./lrubench (frames)\n");
+    return 1;
+  }
+
+  /* Setup may allocate, the frames may not */
+  void *vram = malloc(CACHE_SLOTS * SLOT_SIZE);
+  pool_create(&pool, vram, CACHE_SLOTS * SLOT_SIZE, CACHE_SLOTS);
+  cache_set_size(&cache, CACHE_SLOTS);
+  cache_callback_userdata(&cache, &pool);
+  cache_callback_add(&cache, pool_add_cb);
+  cache_callback_del(&cache, pool_del_cb);
+
+  char keys[NUM_GAMES][16];
+  for (int i = 0; i < NUM_GAMES; i++) {
+    snprintf(keys[i], sizeof(keys[i]), "P%08X", (unsigned int)(i * 0x2000));
+  }
+
+  srand(2026);
+  int top = 0, wrong = 0;
+  unsigned long lookups = 0, hits = 0;
+  double elapsed = 0, model_elapsed = 0;
+  counting = 1;
+  for (int f = 0; f < frames; f++) {
+    if (f % 30 == 0) {
+      top = (rand() % 50 == 0) ? rand() % (NUM_GAMES - TILES) : (top + ROW) % (NUM_GAMES - TILES);
+    }
+    int slots[TILES];
+    double start = now_us();
+    for (int t = 0; t < TILES; t++) {
+      slots[t] = cache_get(keys[top + t]);
+    }
+    elapsed += now_us() - start;
+
+    start = now_us();
+    for (int t = 0; t < TILES; t++) {
+      int hit;
+      const unsigned int expected = model_get(keys[top + t], &hit);
+      hits += hit;
+      lookups++;
+      if ((unsigned int)slots[t] != expected && !wrong++) {
+        printf("ERR: frame %d %s got slot %d, expected %u!\n", f, keys[top + t], slots[t], expected);
+      }
+    }
+    model_elapsed += now_us() - start;
+  }
+  counting = 0;
+
+  printf("\n%d frames, %lu lookups, %.1f%% hits, %u evictions\n", frames, lookups, 100.0 * hits / lookups,
+         evictions);
+  printf("%.1f ns per lookup, %.1f ns for the reference\n", elapsed * 1000.0 / lookups,
+         model_elapsed * 1000.0 / lookups);
+  printf("%u heap calls while drawing\n", heap_calls);
+
+  empty_cache(&cache);
+  pool_destroy(&pool);
+  free(vram);
+  return (wrong || heap_calls) ? 1 : EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -21,21 +22,50 @@
 
 #include <backend/db_item.h>
 #include <ini.h>
+#include <uthash.h>
 
 #include "dat_packer_interface.h"
 
 /* Called:
-./metapack FOLDER output.dat
+./metapack FOLDER output.dat (-v1) (-compact|-legacy)
 
 packs the items in the folder into the output.dat
+the item table is written sorted (DAT2) unless -v1 is given
+chunks are the original fixed 384 byte chunks, which the GD MENU Card
+Manager also reads back from the card, -legacy asks for them explicitly
+-compact writes the numeric fields with an offset into a string pool of
+deduplicated descriptions, appended after the last chunk, for cards only
+openMenu reads
 */
 
 #define NUM_ARGS (2)
 
+/* Everything a meta ini can hold, before it is packed */
+typedef struct meta_ini {
+#define DB_ITEM_STRI(s, n, default)      char n[DB_DESCRIPTION_LEN];
+#define DB_ITEM_CHAR(s, n, default)      unsigned char n;
+#define DB_ITEM_GENRE(s, n, default)     unsigned short n;
+#define DB_ITEM_ACCESSORY(s, n, default) unsigned char n;
+#include "backend/db_item.def"
+} meta_ini;
+
+/* A description already in the pool */
+typedef struct pool_string {
+  const char *text;
+  uint32_t offset;
+  UT_hash_handle hh;
+} pool_string;
+
 /* Locals */
 static bin_header file_header;
 static bin_item_raw *bin_items;
 static unsigned char *data_buf;
+static int legacy_chunks = 1; /* Card Manager only loads these */
+static char *pool;
+static uint32_t pool_len;
+static uint32_t pool_cap;
+static pool_string *pool_strings;
+static uint32_t pool_refs;
 
 static inline long int filelen(FILE *f) {
   long int end;
@@ -160,12 +190,12 @@ static unsigned short meta_parse_accessories(const char *accessories) {
 
 static int read_meta_ini(void *user, const char *section, const char *name, const char *value) {
   /* Parsing Meta into struct */
-  db_item *item = (db_item *)user;
+  meta_ini *item = (meta_ini *)user;
 
   if (0)
     ;
 #define DB_ITEM_STRI(s, n, default) else if (strcasecmp(section, #s) == 0 && \
-                                             strcasecmp(name, #n) == 0) strcpy(item->n, value);
+                                             strcasecmp(name, #n) == 0) snprintf(item->n, sizeof(item->n), "%s", value);
 #define DB_ITEM_CHAR(s, n, default) else if (strcasecmp(section, #s) == 0 && \
                                              strcasecmp(name, #n) == 0) item->n = (unsigned char)atoi(value);
 #define DB_ITEM_GENRE(s, n, default) else if (strcasecmp(section, #s) == 0 && \
@@ -177,8 +207,8 @@ static int read_meta_ini(void *user, const char *section, const char *name, cons
   return 1;
 }
 
-static void meta_init_item(db_item *item) {
-  memset(item->description, '\0', sizeof(item->description));
+static void meta_init_item(meta_ini *item) {
+  memset(item, '\0', sizeof(meta_ini));
 #define DB_ITEM_STRI(s, n, default) strcpy(item->n, default);
 #define DB_ITEM_CHAR(s, n, default) item->n = default;
 #define DB_ITEM_GENRE(s, n, default) item->n = default;
@@ -186,7 +216,7 @@ static void meta_init_item(db_item *item) {
 #include "backend/db_item.def"
 }
 
-/* buffer is where the db_item struct should be filled */
+/* buffer is where the meta_ini struct should be filled */
 int game_meta_read(const char *filename, void *buffer) {
   /* Always LD/cdrom */
   FILE *ini = fopen(filename, "rb");
@@ -203,7 +233,7 @@ int game_meta_read(const char *filename, void *buffer) {
   /* Forcibly terminate string with newline and NUL */
   ini_buffer[ini_size] = '\n';
   ini_buffer[ini_size + 1] = '\0';
-  db_item *item = (db_item *)buffer;
+  meta_ini *item = (meta_ini *)buffer;
 
   meta_init_item(item);
 
@@ -218,12 +248,79 @@ int game_meta_read(const char *filename, void *buffer) {
   return 0;
 }
 
+/* Offset of text in the pool, identical descriptions are stored once */
+static uint32_t pool_add(const char *text) {
+  pool_string *found;
+  pool_refs++;
+  HASH_FIND_STR(pool_strings, text, found);
+  if (found) {
+    return found->offset;
+  }
+
+  const uint32_t len = (uint32_t)strlen(text) + 1;
+  if (pool_len + len > pool_cap) {
+    pool_cap = (pool_cap ? pool_cap * 2 : 4096) + len;
+    pool = realloc(pool, pool_cap);
+  }
+  found = malloc(sizeof(pool_string));
+  if (!pool || !found) {
+    printf("ERR: no free memory!\n");
+    exit(1);
+  }
+  memcpy(pool + pool_len, text, len);
+  found->text = strdup(text);
+  found->offset = pool_len;
+  HASH_ADD_KEYPTR(hh, pool_strings, found->text, len - 1, found);
+  pool_len += len;
+  return found->offset;
+}
+
+/* Numeric fields as is, the description as a pool offset */
+static void pack_meta(const meta_ini *meta, void *chunk) {
+  if (legacy_chunks) {
+    db_item_legacy *record = (db_item_legacy *)chunk;
+#define DB_ITEM_STRI(s, n, default)      memcpy(record->n, meta->n, sizeof(record->n));
+#define DB_ITEM_CHAR(s, n, default)      record->n = meta->n;
+#define DB_ITEM_GENRE(s, n, default)     record->n = meta->n;
+#define DB_ITEM_ACCESSORY(s, n, default) record->n = meta->n;
+#include "backend/db_item.def"
+    return;
+  }
+  db_item_packed *record = (db_item_packed *)chunk;
+#define DB_ITEM_STRI(s, n, default)      record->n = pool_add(meta->n);
+#define DB_ITEM_CHAR(s, n, default)      record->n = meta->n;
+#define DB_ITEM_GENRE(s, n, default)     record->n = meta->n;
+#define DB_ITEM_ACCESSORY(s, n, default) record->n = meta->n;
+#include "backend/db_item.def"
+}
+
+/* The pool goes after the last chunk, a uint32_t size then the strings */
+static int write_pool(const char *path) {
+  FILE *fd = fopen(path, "ab");
+  if (!fd) {
+    printf("ERR: unable to open %s for writing!\n", path);
+    return -1;
+  }
+  const int ok = fwrite(&pool_len, sizeof(pool_len), 1, fd) == 1 && (!pool_len || fwrite(pool, pool_len, 1, fd) == 1);
+  fclose(fd);
+  if (!ok) {
+    printf("ERR: unable to write string pool!\n");
+    return -1;
+  }
+  printf("String pool: %u bytes for %u descriptions, %u unique\n", pool_len, pool_refs, HASH_COUNT(pool_strings));
+  /* db_item is the size of a packed chunk on the console, the host has wider pointers */
+  printf("Resident: %zu bytes, was %zu as fixed chunks\n",
+         (size_t)file_header.num_chunks * sizeof(db_item_packed) + pool_len + 1,
+         (size_t)file_header.num_chunks * sizeof(db_item_legacy));
+  return 0;
+}
+
 int add_bin_file(const char *path, const char *folder, struct stat *statptr) {
   char temp_id[12];
   char temp_file[FILENAME_MAX];
 
   if (file_header.chunk_size == 0) {
-    file_header.chunk_size = sizeof(db_item);
+    file_header.chunk_size = legacy_chunks ? sizeof(db_item_legacy) : sizeof(db_item_packed);
     data_buf = malloc(file_header.chunk_size * file_header.padding0); /* Temporarily use padding0 as num_files */
     /* work out if we need padding chunks */
     uint32_t total_header_size = sizeof(bin_header) + (file_header.padding0 * sizeof(bin_item_raw));
@@ -243,8 +340,10 @@ int add_bin_file(const char *path, const char *folder, struct stat *statptr) {
   strcpy(temp_file, folder);
   strcat(temp_file, PATH_SEP);
   strcat(temp_file, path);
-  db_item *record = (db_item *)(data_buf + (file_header.num_chunks * file_header.chunk_size));
+  meta_ini record_ini;
+  meta_ini *record = &record_ini;
   game_meta_read(temp_file, record);
+  pack_meta(record, data_buf + (file_header.num_chunks * file_header.chunk_size));
 
   /* Use filename as ID, remove extension */
   memset(temp_id, '\0', sizeof(temp_id));
@@ -274,13 +373,25 @@ int add_bin_file(const char *path, const char *folder, struct stat *statptr) {
 
 int main(int argc, char **argv) {
   if (argc < NUM_ARGS + 1 /*binary itself*/) {
-    printf("Incorrect usage!\n\t./datpack FOLDER output.dat\n");
+    printf("Incorrect usage!\n\t./metapack FOLDER output.dat (-v1) (-compact|-legacy)\n");
     return 1;
   }
 
   /* Setup file constraints */
   memcpy(&file_header.magic.rich.alpha, "DAT", 3);
-  file_header.magic.rich.version = 1;
+  file_header.magic.rich.version = DAT_VERSION_SORTED;
+  for (int i = NUM_ARGS + 1; i < argc; i++) {
+    if (!strcasecmp(argv[i], "-v1")) {
+      file_header.magic.rich.version = DAT_VERSION_HASHED;
+    } else if (!strcasecmp(argv[i], "-legacy")) {
+      legacy_chunks = 1;
+    } else if (!strcasecmp(argv[i], "-compact")) {
+      legacy_chunks = 0;
+    } else {
+      printf("Incorrect usage!\n\t./metapack FOLDER output.dat (-v1) (-compact|-legacy)\n");
+      return 1;
+    }
+  }
   file_header.chunk_size = 0;
   file_header.num_chunks = 0;
   file_header.padding0 = 0;
@@ -288,6 +399,9 @@ int main(int argc, char **argv) {
   open_output(argv[2]);
   iterate_dir(argv[1], add_bin_file, &file_header, &bin_items);
   write_bin_file(&file_header, bin_items, data_buf);
+  if (!legacy_chunks && write_pool(argv[2])) {
+    return 1;
+  }
 
   return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -10,9 +10,11 @@
 #include <ctype.h>
 #include <dirent.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -20,9 +22,15 @@
 #include "dat_packer_interface.h"
 
 /* Called:
-./datpack FOLDER output.dat
+./datpack FOLDER output.dat (-v1|-lz4|-crc) (-j N)
 
 packs the items in the folder into the output.bin
+the item table is written sorted (DAT2) unless -v1 is given
+-lz4 writes DAT3, each chunk LZ4 compressed with its own offset and length
+-crc writes DAT4, DAT3 plus a CRC32C of every stored chunk for datverify
+chunks are streamed to the output one at a time, only the item table is held
+-j N reads and compresses on N threads, files are still written in name order
+so the output matches a single threaded run byte for byte
 */
 
 #define NUM_ARGS (2)
@@ -30,82 +38,231 @@ packs the items in the folder into the output.bin
 /* Locals */
 static bin_header file_header;
 static bin_item_raw *bin_items;
-static unsigned char *data_buf;
+static const char *pack_folder;
 
-int add_pvr_file(const char *path, const char *folder, struct stat *statptr) {
-  char temp_id[12];
-  char temp_file[FILENAME_MAX];
+/* One file to pack, in the order iterate_dir visits them */
+typedef struct pack_job {
+  char *name;
+  off_t size;
+} pack_job;
+
+/* A loaded file waiting for the writer */
+typedef struct pack_slot {
+  unsigned char *chunk;
+  unsigned char *scratch;
+  const void *stored;
+  uint32_t length;
+  char ID[12];
+  int status; /* 0 = loading, 1 = ready, -1 = skipped */
+} pack_slot;
+
+static pack_job *jobs;
+static uint32_t num_jobs;
 
+/* Worker pool, jobs are handed out in order and written in the same order */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+static pack_slot *slots;
+static uint32_t num_slots;
+static uint32_t next_job;
+static uint32_t jobs_written;
+
+int add_pvr_file(const char *path, const char *folder, struct stat *statptr) {
+  (void)folder;
   if (file_header.chunk_size == 0) {
     file_header.chunk_size = (uint32_t)statptr->st_size;
-    data_buf = malloc(file_header.chunk_size * file_header.padding0); /* Temporarily use padding0 as num_files */
-  } else {
-    if (statptr->st_size != file_header.chunk_size) {
-      printf("Err: Filesize mismatch for %s, found %lld vs %u!\n", path, statptr->st_size, file_header.chunk_size);
-      return -1;
+    jobs = malloc(sizeof(pack_job) * file_header.padding0); /* iterate_dir left the file count in padding0 */
+    if (!jobs) {
+      printf("ERR: no free memory!\n");
+      exit(1);
     }
   }
-  /* Check if filename too long, dont try to reconcile, just skip */
-  char *dot = strrchr(path, '.');
-  if ((size_t)dot - (size_t)path > 11) {
-    printf("Err: filename too long \"%s\", maxlength = 11!\n", path);
+  jobs[num_jobs].name = strdup(path);
+  jobs[num_jobs].size = statptr->st_size;
+  num_jobs++;
+  return 0;
+}
+
+/* Reads, validates and packs one file, touches nothing but the job and slot */
+static int load_pvr_file(const pack_job *job, pack_slot *slot) {
+  char temp_file[FILENAME_MAX];
+  const char *path = job->name;
+
+  if (job->size != file_header.chunk_size) {
+    printf("Err: Filesize mismatch for %s, found %lld vs %u!\n", path, (long long)job->size, file_header.chunk_size);
+    return -1;
+  }
+  if (make_item_ID(path, slot->ID)) {
     return -1;
   }
 
-  temp_file[0] = '\0';
-  strcpy(temp_file, folder);
-  strcat(temp_file, PATH_SEP);
-  strcat(temp_file, path);
+  snprintf(temp_file, sizeof(temp_file), "%s" PATH_SEP "%s", pack_folder, path);
   FILE *temp_fd = fopen(temp_file, "rb");
   if (!temp_fd) {
     printf("ERR: cant read %s\n", temp_file);
     return -1;
   }
-  fread(data_buf + (file_header.num_chunks * file_header.chunk_size), file_header.chunk_size, 1, temp_fd);
+  const size_t read = fread(slot->chunk, file_header.chunk_size, 1, temp_fd);
   fclose(temp_fd);
+  if (read != 1) {
+    printf("ERR: short read on %s\n", temp_file);
+    return -1;
+  }
 
-  /* Use filename as ID, remove extension */
-  printf("Working on %s\n", path);
-  memset(temp_id, '\0', sizeof(temp_id));
-  strncpy(temp_id, path, 11);
-  char *end = strrchr(temp_id, '.');
-  if (end) {
-    const size_t nul_len = sizeof(temp_id) - ((size_t)end - (size_t)temp_id);
-    memset(end, '\0', nul_len);
+  slot->length = pack_stream_chunk(&file_header, slot->chunk, slot->scratch, &slot->stored);
+  return 0;
+}
+
+static int write_slot(uint32_t job, const pack_slot *slot) {
+  if (slot->status != 1) {
+    return 0;
   }
-  char *temp_start = temp_id;
-  while (*temp_start) {
-    *temp_start = toupper(*temp_start);
-    ++temp_start;
+  if (append_stream_stored(&file_header, bin_items, slot->ID, slot->stored, slot->length)) {
+    return -1;
   }
-  temp_id[11] = '\0';
-  temp_id[10] = '\0';
-  memcpy(&bin_items[file_header.num_chunks].ID, temp_id, sizeof(bin_items->ID));
+  printf("Added[%u] as %s from %s\n", file_header.num_chunks, slot->ID, jobs[job].name);
+  return 0;
+}
+
+static void *pack_worker(void *arg) {
+  (void)arg;
+  for (;;) {
+    pthread_mutex_lock(&pool_lock);
+    /* Never run more than num_slots ahead of the writer */
+    while (next_job < num_jobs && next_job >= jobs_written + num_slots) {
+      pthread_cond_wait(&pool_cond, &pool_lock);
+    }
+    if (next_job >= num_jobs) {
+      pthread_mutex_unlock(&pool_lock);
+      return NULL;
+    }
+    const uint32_t job = next_job++;
+    pthread_mutex_unlock(&pool_lock);
 
-  bin_items[file_header.num_chunks].offset = file_header.num_chunks + 1;
-  (void)file_header.num_chunks++;
+    pack_slot *slot = &slots[job % num_slots];
+    const int ret = load_pvr_file(&jobs[job], slot);
 
-  printf("Added[%u] as %s\n", file_header.num_chunks, temp_id);
-  return 0;
+    pthread_mutex_lock(&pool_lock);
+    slot->status = ret ? -1 : 1;
+    pthread_cond_broadcast(&pool_cond);
+    pthread_mutex_unlock(&pool_lock);
+  }
+}
+
+static int pack_jobs(int num_threads) {
+  /* Two slots per worker keeps them busy while the writer catches up */
+  num_slots = (num_threads > 1) ? (uint32_t)num_threads * 2 : 1;
+  slots = calloc(num_slots, sizeof(pack_slot));
+  if (!slots) {
+    printf("ERR: no free memory!\n");
+    return -1;
+  }
+  for (uint32_t i = 0; i < num_slots; i++) {
+    slots[i].chunk = malloc(file_header.chunk_size);
+    slots[i].scratch = malloc(file_header.chunk_size);
+    if (!slots[i].chunk || !slots[i].scratch) {
+      printf("ERR: no free memory!\n");
+      return -1;
+    }
+  }
+
+  if (num_threads <= 1) {
+    for (uint32_t i = 0; i < num_jobs; i++) {
+      slots[0].status = load_pvr_file(&jobs[i], &slots[0]) ? -1 : 1;
+      if (write_slot(i, &slots[0])) {
+        return -1;
+      }
+    }
+    return 0;
+  }
+
+  pthread_t *workers = malloc(sizeof(pthread_t) * num_threads);
+  if (!workers) {
+    printf("ERR: no free memory!\n");
+    return -1;
+  }
+  for (int i = 0; i < num_threads; i++) {
+    pthread_create(&workers[i], NULL, pack_worker, NULL);
+  }
+
+  int ret = 0;
+  for (uint32_t i = 0; i < num_jobs && !ret; i++) {
+    pack_slot *slot = &slots[i % num_slots];
+    pthread_mutex_lock(&pool_lock);
+    while (!slot->status) {
+      pthread_cond_wait(&pool_cond, &pool_lock);
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    ret = write_slot(i, slot);
+
+    pthread_mutex_lock(&pool_lock);
+    slot->status = 0;
+    jobs_written = i + 1;
+    pthread_cond_broadcast(&pool_cond);
+    pthread_mutex_unlock(&pool_lock);
+  }
+
+  /* On a write error let the workers drain out */
+  if (ret) {
+    pthread_mutex_lock(&pool_lock);
+    next_job = num_jobs;
+    pthread_cond_broadcast(&pool_cond);
+    pthread_mutex_unlock(&pool_lock);
+  }
+  for (int i = 0; i < num_threads; i++) {
+    pthread_join(workers[i], NULL);
+  }
+  free(workers);
+  return ret;
 }
 
 int main(int argc, char **argv) {
+  int num_threads = 1;
+
   if (argc < NUM_ARGS + 1 /*binary itself*/) {
-    printf("Incorrect usage!\n\t./datpack FOLDER output.dat\n");
+    printf("Incorrect usage!\n\t./datpack FOLDER output.dat (-v1|-lz4|-crc) (-j N)\n");
     return 1;
   }
 
   /* Setup file constraints */
   memcpy(&file_header.magic.rich.alpha, "DAT", 3);
-  file_header.magic.rich.version = 1;
+  file_header.magic.rich.version = DAT_VERSION_SORTED;
+  for (int i = NUM_ARGS + 1; i < argc; i++) {
+    if (!strcasecmp(argv[i], "-v1")) {
+      file_header.magic.rich.version = DAT_VERSION_HASHED;
+    } else if (!strcasecmp(argv[i], "-lz4")) {
+      file_header.magic.rich.version = DAT_VERSION_PACKED;
+    } else if (!strcasecmp(argv[i], "-crc")) {
+      file_header.magic.rich.version = DAT_VERSION_CHECKED;
+    } else if (!strcmp(argv[i], "-j") && (i + 1 < argc) && atoi(argv[i + 1]) > 0) {
+      num_threads = atoi(argv[++i]);
+    } else {
+      printf("Incorrect usage!\n\t./datpack FOLDER output.dat (-v1|-lz4|-crc) (-j N)\n");
+      return 1;
+    }
+  }
   file_header.chunk_size = 0;
   file_header.num_chunks = 0;
   file_header.padding0 = 0;
 
-  open_output(argv[2]);
+  pack_folder = argv[1];
   iterate_dir(argv[1], add_pvr_file, &file_header, &bin_items);
-  file_header.padding0 = 0;
-  write_bin_file(&file_header, bin_items, data_buf);
+  if (!num_jobs) {
+    printf("ERR: nothing to pack!\n");
+    return 1;
+  }
+
+  open_output(argv[2]);
+  if (begin_stream_file(&file_header, num_jobs) || pack_jobs(num_threads)) {
+    printf("ERR: unable to write %s!\n", argv[2]);
+    return 1;
+  }
+  if (!file_header.num_chunks) {
+    printf("ERR: nothing packed!\n");
+    return 1;
+  }
+  finish_stream_file(&file_header, bin_items);
 
   return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,496 @@
+/*
+ * File: patcher.c
+ * Project: tools
+ * File Created: Friday, 16th October 2026 3:20:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#include <texture/crc32c.h>
+
+#include "dat_packer_interface.h"
+
+/* Called:
+./datpatch target.dat (FILE.pvr | -d ID)... (--compact)
+
+Updates a DAT in place without repacking it
+FILE.pvr adds that file, or overwrites the chunk already holding its ID
+-d ID tombstones an entry, its ID is cleared and the space left for reuse
+--compact rewrites the DAT with only live entries, after any other changes
+
+Only new or replaced chunks and the item table are written. When the table
+outgrows the space in front of the first chunk, the lowest chunks are moved to
+the end of the file to make room. Chunks shared by several IDs are never
+overwritten, a replacement goes to the end instead
+
+DAT4 checksums are loaded with the table and only the chunks written here are
+hashed, so a patch never reads the rest of the file back
+
+Every file added or replaced is read back from the patched DAT and compared
+before returning, and every ID deleted is looked up to check it is gone. A
+mismatch fails the run
+*/
+
+#define NUM_ARGS (2)
+
+/* Working copy of the item table, byte offsets and stored length for all versions */
+static bin_header file_header;
+static bin_item_packed *table;
+static uint32_t *table_crc; /* ver4 only, follows table entry for entry */
+static uint32_t table_len;
+static uint32_t table_cap;
+static size_t entry_size;
+static FILE *dat_fd;
+static long file_end;
+static unsigned char *chunk_buf;
+static unsigned char *scratch_buf;
+static unsigned char *move_buf; /* Chunks moved for table space, chunk_buf may hold the one being added */
+static size_t bytes_written;
+
+static int is_tombstone(const bin_item_packed *item) {
+  return item->ID[0] == '\0';
+}
+
+static bin_item_packed *find_entry(const char *ID) {
+  for (uint32_t i = 0; i < table_len; i++) {
+    if (!strncmp(table[i].ID, ID, sizeof(table[i].ID))) {
+      return &table[i];
+    }
+  }
+  return NULL;
+}
+
+/* Deduplicated DATs point several IDs at one chunk, those must not be overwritten */
+static int is_shared(const bin_item_packed *item) {
+  for (uint32_t i = 0; i < table_len; i++) {
+    if (&table[i] != item && table[i].offset == item->offset && !is_tombstone(&table[i])) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Next place a chunk can go, ver1 and ver2 chunks must sit on a chunk boundary */
+static long append_offset(void) {
+  if (DAT_VERSION_IS_PACKED(file_header.magic.rich.version)) {
+    return file_end;
+  }
+  return ((file_end + file_header.chunk_size - 1) / file_header.chunk_size) * file_header.chunk_size;
+}
+
+static int write_at(long offset, const void *data, uint32_t length) {
+  fseek(dat_fd, offset, SEEK_SET);
+  if (fwrite(data, length, 1, dat_fd) != 1) {
+    printf("ERR: write failed at 0x%lX!\n", offset);
+    return -1;
+  }
+  bytes_written += length;
+  if (offset + (long)length > file_end) {
+    file_end = offset + length;
+  }
+  return 0;
+}
+
+static int load_table(const char *path) {
+  dat_file bin;
+  DAT_init(&bin);
+  if (DAT_load_parse(&bin, path)) {
+    return -1;
+  }
+
+  memcpy(&file_header.magic.rich.alpha, "DAT", 3);
+  file_header.magic.rich.version = bin.version;
+  file_header.chunk_size = bin.chunk_size;
+  file_header.num_chunks = bin.num_chunks;
+  file_header.padding0 = 0;
+  entry_size = dat_entry_size(bin.version);
+
+  table_len = bin.num_chunks;
+  table_cap = bin.num_chunks + 16;
+  table = malloc(table_cap * sizeof(bin_item_packed));
+  if (!table) {
+    printf("ERR: no free memory!\n");
+    DAT_close(&bin);
+    return -1;
+  }
+  if (bin.version == DAT_VERSION_CHECKED) {
+    table_crc = malloc(table_cap * sizeof(uint32_t));
+    if (!table_crc) {
+      printf("ERR: no free memory!\n");
+      DAT_close(&bin);
+      return -1;
+    }
+    if (table_len) {
+      memcpy(table_crc, bin.crc, table_len * sizeof(uint32_t));
+    }
+  }
+  for (uint32_t i = 0; i < table_len; i++) {
+    if (DAT_VERSION_IS_PACKED(bin.version)) {
+      table[i] = bin.packed[i];
+    } else {
+      memcpy(table[i].ID, bin.index[i].ID, sizeof(table[i].ID));
+      table[i].offset = bin.index[i].offset * bin.chunk_size;
+      table[i].length = bin.chunk_size;
+    }
+  }
+  DAT_close(&bin);
+
+  chunk_buf = malloc(file_header.chunk_size);
+  scratch_buf = malloc(file_header.chunk_size);
+  move_buf = malloc(file_header.chunk_size);
+  if (!chunk_buf || !scratch_buf || !move_buf) {
+    printf("ERR: no free memory!\n");
+    return -1;
+  }
+  return 0;
+}
+
+/* Start of the lowest chunk, the table can grow up to here */
+static uint32_t lowest_entry(void) {
+  uint32_t lowest = 0;
+  for (uint32_t i = 1; i < table_len; i++) {
+    if (table[i].offset < table[lowest].offset) {
+      lowest = i;
+    }
+  }
+  return lowest;
+}
+
+static int make_table_room(uint32_t num_entries) {
+  const size_t needed = sizeof(bin_header) + (num_entries * entry_size);
+  while (table_len) {
+    const uint32_t low = lowest_entry();
+    if (needed <= table[low].offset) {
+      return 0;
+    }
+
+    /* Dead entries just go, live ones move to the end of the file */
+    if (is_tombstone(&table[low])) {
+      table[low] = table[--table_len];
+      if (table_crc) {
+        table_crc[low] = table_crc[table_len];
+      }
+      continue;
+    }
+    fseek(dat_fd, table[low].offset, SEEK_SET);
+    if (fread(move_buf, table[low].length, 1, dat_fd) != 1) {
+      printf("ERR: unable to read %.12s for moving!\n", table[low].ID);
+      return -1;
+    }
+    const long offset = append_offset();
+    if (write_at(offset, move_buf, table[low].length)) {
+      return -1;
+    }
+    printf("Moved %.12s to 0x%lX for table space\n", table[low].ID, offset);
+    const uint32_t old_offset = table[low].offset;
+    for (uint32_t i = 0; i < table_len; i++) {
+      if (table[i].offset == old_offset) {
+        table[i].offset = (uint32_t)offset;
+      }
+    }
+  }
+
+  /* An empty table has nothing to move, keep new chunks clear of it instead */
+  if ((long)needed > file_end) {
+    file_end = (long)needed;
+  }
+  return 0;
+}
+
+/* Reads a whole input file into buf and works out its ID */
+static int read_input(const char *path, char *ID, void *buf) {
+  const char *filename = strrchr(path, PATH_SEP[0]);
+  filename = filename ? filename + 1 : path;
+  if (make_item_ID(filename, ID)) {
+    return -1;
+  }
+
+  FILE *fd = fopen(path, "rb");
+  if (!fd) {
+    printf("ERR: cant read %s\n", path);
+    return -1;
+  }
+  fseek(fd, 0, SEEK_END);
+  const long size = ftell(fd);
+  fseek(fd, 0, SEEK_SET);
+  if (size != (long)file_header.chunk_size) {
+    printf("Err: Filesize mismatch for %s, found %ld vs %u!\n", path, size, file_header.chunk_size);
+    fclose(fd);
+    return -1;
+  }
+  const size_t read = fread(buf, file_header.chunk_size, 1, fd);
+  fclose(fd);
+  if (read != 1) {
+    printf("ERR: short read on %s\n", path);
+    return -1;
+  }
+  return 0;
+}
+
+/* Writes the stored bytes of item, its ver4 checksum is taken from them on the way */
+static int write_item(bin_item_packed *item, const void *stored, uint32_t length) {
+  item->length = length;
+  if (table_crc) {
+    table_crc[item - table] = crc32c(0, stored, length);
+  }
+  return write_at(item->offset, stored, length);
+}
+
+static int put_file(const char *path, char *ID) {
+  if (read_input(path, ID, chunk_buf)) {
+    return -1;
+  }
+
+  const void *stored;
+  const uint32_t length = pack_stream_chunk(&file_header, chunk_buf, scratch_buf, &stored);
+
+  /* Overwrite in place when it fits, ver1 and ver2 chunks always do */
+  bin_item_packed *item = find_entry(ID);
+  if (item && length <= item->length && !is_shared(item)) {
+    printf("Replaced %s in place\n", ID);
+    return write_item(item, stored, length);
+  }
+  if (item) {
+    item->offset = (uint32_t)append_offset();
+    printf("Replaced %s at end\n", ID);
+    return write_item(item, stored, length);
+  }
+
+  /* Reuse a tombstoned slot before growing anything */
+  for (uint32_t i = 0; i < table_len; i++) {
+    if (is_tombstone(&table[i]) && length <= table[i].length && !is_shared(&table[i])) {
+      memcpy(table[i].ID, ID, sizeof(table[i].ID));
+      printf("Added %s over a deleted entry\n", ID);
+      return write_item(&table[i], stored, length);
+    }
+  }
+
+  if (table_len == table_cap) {
+    table_cap *= 2;
+    bin_item_packed *grown = realloc(table, table_cap * sizeof(bin_item_packed));
+    if (!grown) {
+      printf("ERR: no free memory!\n");
+      return -1;
+    }
+    table = grown;
+    if (table_crc) {
+      uint32_t *grown_crc = realloc(table_crc, table_cap * sizeof(uint32_t));
+      if (!grown_crc) {
+        printf("ERR: no free memory!\n");
+        return -1;
+      }
+      table_crc = grown_crc;
+    }
+  }
+  if (make_table_room(table_len + 1)) {
+    return -1;
+  }
+  item = &table[table_len++];
+  memcpy(item->ID, ID, sizeof(item->ID));
+  item->offset = (uint32_t)append_offset();
+  printf("Added %s\n", ID);
+  return write_item(item, stored, length);
+}
+
+static int delete_ID(const char *arg, char *ID) {
+  memset(ID, '\0', 12);
+  strncpy(ID, arg, 11);
+  for (char *c = ID; *c; c++) {
+    *c = toupper(*c);
+  }
+
+  bin_item_packed *item = find_entry(ID);
+  if (!item) {
+    printf("Err: %s not found, nothing to delete!\n", ID);
+    return -1;
+  }
+  memset(item->ID, '\0', sizeof(item->ID));
+  printf("Deleted %s\n", ID);
+  return 0;
+}
+
+/* Chunks are already out, the table goes last so it never points at unwritten data */
+static int write_table(void) {
+  if (table_crc) {
+    if (sort_checked_index(table, table_crc, table_len)) {
+      return -1;
+    }
+  } else if (file_header.magic.rich.version != DAT_VERSION_HASHED) {
+    DAT_sort_packed_index(table, table_len);
+  }
+  file_header.num_chunks = table_len;
+  if (!DAT_VERSION_IS_PACKED(file_header.magic.rich.version) && table_len) {
+    file_header.padding0 = (table[lowest_entry()].offset / file_header.chunk_size) - 1;
+  }
+  fflush(dat_fd);
+
+  fseek(dat_fd, sizeof(bin_header), SEEK_SET);
+  for (uint32_t i = 0; i < table_len; i++) {
+    if (DAT_VERSION_IS_PACKED(file_header.magic.rich.version)) {
+      fwrite(&table[i], sizeof(bin_item_packed), 1, dat_fd);
+    } else {
+      bin_item_raw raw;
+      memcpy(raw.ID, table[i].ID, sizeof(raw.ID));
+      raw.offset = table[i].offset / file_header.chunk_size;
+      fwrite(&raw, sizeof(bin_item_raw), 1, dat_fd);
+    }
+  }
+  bytes_written += table_len * entry_size;
+  if (table_crc && write_checksum_table(dat_fd, table_crc, table_len)) {
+    return -1;
+  }
+  return write_at(0, &file_header, sizeof(bin_header));
+}
+
+/* Reads every file put back out of the patched DAT, put_ok marks the args to check
+   del_ok marks deletes still standing, those IDs and the empty ID must not be found */
+static int verify_puts(const char *path, int argc, char **argv, char (*arg_IDs)[12], const unsigned char *put_ok,
+                       const unsigned char *del_ok) {
+  dat_file bin;
+  char ID[12];
+  int wrong = 0;
+
+  fflush(dat_fd);
+  DAT_init(&bin);
+  if (DAT_load_parse(&bin, path)) {
+    printf("ERR: unable to reopen %s to check it!\n", path);
+    return -1;
+  }
+  for (int i = NUM_ARGS; i < argc; i++) {
+    if (del_ok[i] && (DAT_get_index_by_ID(&bin, arg_IDs[i]) != DAT_INDEX_NONE || DAT_get_offset_by_ID(&bin, ""))) {
+      printf("ERR: %s is still found after deleting it!\n", arg_IDs[i]);
+      wrong = 1;
+    }
+    if (!put_ok[i] || read_input(argv[i], ID, chunk_buf)) {
+      continue;
+    }
+    if (!DAT_read_file_by_ID(&bin, ID, scratch_buf) || memcmp(chunk_buf, scratch_buf, file_header.chunk_size)) {
+      printf("ERR: %s reads back wrong after patching!\n", ID);
+      wrong = 1;
+    }
+  }
+  DAT_close(&bin);
+  return wrong ? -1 : 0;
+}
+
+/* Rewrites just the live entries through the datpack streaming writer */
+static int compact(const char *path) {
+  char temp_path[FILENAME_MAX];
+  uint32_t live = 0;
+  for (uint32_t i = 0; i < table_len; i++) {
+    live += !is_tombstone(&table[i]);
+  }
+
+  snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+  open_output(temp_path);
+  bin_header out_header = file_header;
+  out_header.num_chunks = 0;
+  bin_item_raw *out_items = malloc((live + 1) * sizeof(bin_item_raw));
+  if (!out_items || begin_stream_file(&out_header, live)) {
+    printf("ERR: unable to start %s!\n", temp_path);
+    return -1;
+  }
+
+  for (uint32_t i = 0; i < table_len; i++) {
+    if (is_tombstone(&table[i])) {
+      continue;
+    }
+    fseek(dat_fd, table[i].offset, SEEK_SET);
+    if (fread(chunk_buf, table[i].length, 1, dat_fd) != 1) {
+      printf("ERR: unable to read %.12s!\n", table[i].ID);
+      return -1;
+    }
+    /* Stored bytes are copied as is, ver3 chunks are not recompressed */
+    if (append_stream_stored(&out_header, out_items, table[i].ID, chunk_buf, table[i].length)) {
+      return -1;
+    }
+  }
+  finish_stream_file(&out_header, out_items);
+  free(out_items);
+
+  fclose(dat_fd);
+  dat_fd = NULL;
+  if (rename(temp_path, path)) {
+    printf("ERR: unable to replace %s with %s!\n", path, temp_path);
+    return -1;
+  }
+  printf("Compacted %u of %u entries\n", live, table_len);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc < NUM_ARGS + 1 /*binary itself*/) {
+    printf("Incorrect usage!\n\t./datpatch target.dat (FILE.pvr | -d ID)... (--compact)\n");
+    return 1;
+  }
+
+  const char *path = argv[1];
+  if (load_table(path)) {
+    return 1;
+  }
+  dat_fd = fopen(path, "r+b");
+  if (!dat_fd) {
+    printf("ERR: unable to open %s for writing!\n", path);
+    return 1;
+  }
+  fseek(dat_fd, 0, SEEK_END);
+  file_end = ftell(dat_fd);
+
+  /* ID each arg changed, only the last put of an ID still standing is checked */
+  char (*arg_IDs)[12] = calloc(argc, sizeof(*arg_IDs));
+  unsigned char *put_ok = calloc(argc, 1);
+  unsigned char *del_ok = calloc(argc, 1);
+  if (!arg_IDs || !put_ok || !del_ok) {
+    printf("ERR: no free memory!\n");
+    return 1;
+  }
+  int do_compact = 0;
+  int changed = 0;
+  int failed = 0;
+  for (int i = NUM_ARGS; i < argc; i++) {
+    const int arg = i;
+    if (!strcasecmp(argv[i], "--compact")) {
+      do_compact = 1;
+      continue;
+    }
+    if (!strcmp(argv[i], "-d") && (i + 1 < argc)) {
+      del_ok[arg] = !delete_ID(argv[++i], arg_IDs[arg]);
+      failed |= !del_ok[arg];
+    } else {
+      put_ok[arg] = !put_file(argv[i], arg_IDs[arg]);
+      failed |= !put_ok[arg];
+    }
+    changed = 1;
+    for (int j = NUM_ARGS; j < arg; j++) {
+      if (!strncmp(arg_IDs[j], arg_IDs[arg], sizeof(arg_IDs[j]))) {
+        put_ok[j] = 0;
+        del_ok[j] = 0;
+      }
+    }
+  }
+
+  if (changed && write_table()) {
+    return 1;
+  }
+  printf("Wrote %zu bytes to %s\n", bytes_written, path);
+  if (changed && verify_puts(path, argc, argv, arg_IDs, put_ok, del_ok)) {
+    return 1;
+  }
+  free(del_ok);
+  free(put_ok);
+  free(arg_IDs);
+  if (do_compact && compact(path)) {
+    return 1;
+  }
+  if (dat_fd) {
+    fclose(dat_fd);
+  }
+
+  return failed ? 1 : EXIT_SUCCESS;
+}
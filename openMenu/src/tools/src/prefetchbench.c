@@ -0,0 +1,292 @@
+/*
+ * File: prefetchbench.c
+ * Project: tools
+ * File Created: Friday, 16th October 2026 1:25:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <backend/dat_format.h>
+
+#include "block_pool.h"
+#include "lru.h"
+#include "txr_prefetch.h"
+
+/* Called:
+./prefetchbench (frames) (usec per cover read)
+
+Scrolls a 4x3 grid down and back up a synthetic 240 cover DAT at 60 frames
+a second, first loading covers inside the frame the way txr_get_from_dat_set
+used to, then through txr_prefetch with the next page hinted. Cover reads
+sleep to stand in for the disc, uploads are a memcpy into the slot.
+Reports the time spent in each frame, how often it overran 16.7ms and how
+many tiles were drawn as missing while their cover was on its way.
+Returns 1 if any tile shows the wrong cover.
+*/
+
+#define BENCH_FILE   "prefetchbench.tmp"
+#define NUM_COVERS   (240)
+#define CHUNK_SIZE   (128 * 128 * 2)
+#define CACHE_SLOTS  (16)
+#define STAGING      (16)
+#define COLUMNS      (4)
+#define TILES        (12)
+#define FRAME_USEC   (1000000.0 / 60.0)
+
+static dat_file bin;
+static block_pool pool;
+static cache_instance cache;
+static prefetch_queue staging;
+static void *sync_buf;
+static long read_usec = 10000;
+static unsigned int wrong;
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+static void sleep_until_us(double when) {
+  const double wait = when - now_us();
+  if (wait > 0) {
+    struct timespec ts = {.tv_sec = (time_t)(wait / 1000000.0), .tv_nsec = (long)fmod(wait, 1000000.0) * 1000};
+    nanosleep(&ts, NULL);
+  }
+}
+
+/* Stand-in for the disc, the read itself comes out of the page cache */
+static int slow_read(const dat_file *dat, uint32_t chunk_num, void *buf) {
+  sleep_until_us(now_us() + read_usec);
+  return DAT_read_file_by_num(dat, chunk_num, buf);
+}
+
+/* Each chunk starts with the cover number it belongs to */
+static int write_cover_dat(const char *path) {
+  bin_header header;
+  bin_item_raw *items = calloc(NUM_COVERS, sizeof(bin_item_raw));
+  unsigned char *chunk = calloc(1, CHUNK_SIZE);
+  FILE *fd = fopen(path, "wb");
+  if (!items || !chunk || !fd) {
+    free(items);
+    free(chunk);
+    if (fd) {
+      fclose(fd);
+    }
+    return -1;
+  }
+
+  const uint32_t header_chunks = ((sizeof(bin_header) + NUM_COVERS * sizeof(bin_item_raw)) / CHUNK_SIZE) + 1;
+  for (unsigned int i = 0; i < NUM_COVERS; i++) {
+    snprintf(items[i].ID, sizeof(items[i].ID), "T%05uN", i);
+    items[i].offset = header_chunks + i;
+  }
+  DAT_sort_index(items, NUM_COVERS);
+
+  memcpy(&header.magic.rich.alpha, "DAT", 3);
+  header.magic.rich.version = DAT_VERSION_SORTED;
+  header.chunk_size = CHUNK_SIZE;
+  header.num_chunks = NUM_COVERS;
+  header.padding0 = 0;
+  fwrite(&header, sizeof(header), 1, fd);
+  fwrite(items, sizeof(bin_item_raw), NUM_COVERS, fd);
+  const size_t padding = (header_chunks * CHUNK_SIZE) - (size_t)ftell(fd);
+  fwrite(chunk, padding, 1, fd);
+  for (uint32_t i = 0; i < NUM_COVERS; i++) {
+    memcpy(chunk, &i, sizeof(i));
+    fwrite(chunk, CHUNK_SIZE, 1, fd);
+  }
+  fclose(fd);
+  free(chunk);
+  free(items);
+  return 0;
+}
+
+static unsigned int pool_add_cb(const char *key, void *user) {
+  (void)key;
+  unsigned int slot;
+  void *ptr;
+  pool_get_next_free((block_pool *)user, &slot, &ptr);
+  return slot;
+}
+
+static unsigned int pool_del_cb(const char *key, void *value, void *user) {
+  (void)key;
+  pool_dealloc_slot((block_pool *)user, *(unsigned int *)value);
+  return 0;
+}
+
+/* Stand-in upload backend, pvr_txr_load on the console */
+static void upload(const void *chunk, int slot) {
+  memcpy(pool_get_slot_addr(&pool, slot), chunk, CHUNK_SIZE);
+  pool_set_slot_format(&pool, slot, 128, 128, 1);
+}
+
+static void cover_key(unsigned int cover, char id[12], char key[16]) {
+  snprintf(id, 12, "T%05uN", cover);
+  snprintf(key, 16, "P%08lX", (unsigned long)DAT_get_offset_by_ID(&bin, id));
+}
+
+/* As txr_get_from_dat_set does it, returns 0 when the tile shows as missing */
+static int draw_tile(unsigned int cover) {
+  char id[12], key[16];
+  cover_key(cover, id, key);
+
+  int slot = find_in_cache(&cache, key);
+  if (slot == -1) {
+    const int staged = prefetch_running() ? prefetch_fetch(&staging, &bin, DAT_get_index_by_ID(&bin, id), key)
+                                          : (slow_read(&bin, DAT_get_index_by_ID(&bin, id), sync_buf) ? -2 : -1);
+    if (staged == -1) {
+      return 0;
+    }
+    add_to_cache(&cache, key, 0);
+    slot = find_in_cache(&cache, key);
+    if (staged == -2) {
+      upload(sync_buf, slot);
+    } else {
+      upload(prefetch_slot_data(&staging, staged), slot);
+      prefetch_release(&staging, staged);
+    }
+  }
+
+  uint32_t stamp;
+  memcpy(&stamp, pool_get_slot_addr(&pool, slot), sizeof(stamp));
+  if (stamp != cover && !wrong++) {
+    printf("ERR: cover %u drawn with %u!\n", cover, stamp);
+  }
+  return 1;
+}
+
+/* As ui_grid does it */
+static void prefetch_next_page(int top, int *prefetched) {
+  if (top == *prefetched || !prefetch_running()) {
+    return;
+  }
+  const int forward = (top > *prefetched);
+  *prefetched = top;
+  prefetch_demote(&staging);
+  for (int i = 0; i < TILES; i++) {
+    const int cover = forward ? (top + TILES + i) : (top - 1 - i);
+    if (cover < 0 || cover >= NUM_COVERS) {
+      break;
+    }
+    char id[12], key[16];
+    cover_key((unsigned int)cover, id, key);
+    if (peek_in_cache(&cache, key) == -1) {
+      prefetch_hint(&staging, &bin, DAT_get_index_by_ID(&bin, id), key);
+    }
+  }
+}
+
+typedef struct run_result {
+  double mean, stddev, worst;
+  int over_budget;
+  unsigned long missing, tiles;
+} run_result;
+
+/* A row every 5 frames held down for 2.5 seconds, a pause, then back up */
+static void run(int frames, run_result *result) {
+  double *frame_us = calloc(frames, sizeof(double));
+  int top = 0, prefetched = -1;
+  memset(result, 0, sizeof(run_result));
+  empty_cache(&cache);
+  pool_dealloc_all(&pool);
+
+  double deadline = now_us();
+  for (int f = 0; f < frames; f++) {
+    const int phase = f % 360;
+    if (phase < 150 && phase % 5 == 0) {
+      top += COLUMNS;
+    } else if (phase >= 180 && phase < 330 && phase % 5 == 0) {
+      top -= COLUMNS;
+    }
+    top = top < 0 ? 0 : (top > NUM_COVERS - TILES ? NUM_COVERS - TILES : top);
+
+    const double start = now_us();
+    prefetch_next_page(top, &prefetched);
+    for (int t = 0; t < TILES; t++) {
+      result->missing += !draw_tile((unsigned int)(top + t));
+      result->tiles++;
+    }
+    frame_us[f] = now_us() - start;
+
+    /* Wait for vblank, a late frame waits for the next one */
+    deadline += FRAME_USEC;
+    while (deadline < now_us()) {
+      deadline += FRAME_USEC;
+    }
+    sleep_until_us(deadline);
+  }
+
+  for (int f = 0; f < frames; f++) {
+    result->mean += frame_us[f] / frames;
+    result->worst = frame_us[f] > result->worst ? frame_us[f] : result->worst;
+    result->over_budget += frame_us[f] > FRAME_USEC;
+  }
+  for (int f = 0; f < frames; f++) {
+    result->stddev += (frame_us[f] - result->mean) * (frame_us[f] - result->mean) / frames;
+  }
+  result->stddev = sqrt(result->stddev);
+  free(frame_us);
+}
+
+static void print_result(const char *name, const run_result *result, int frames) {
+  printf("%-10s %10.1f %10.1f %10.1f %7d/%d %8.2f%%\n", name, result->mean, result->stddev, result->worst,
+         result->over_budget, frames, 100.0 * result->missing / result->tiles);
+}
+
+int main(int argc, char **argv) {
+  int frames = 720;
+  if (argc > 1) {
+    frames = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    read_usec = atol(argv[2]);
+  }
+  if (frames <= 0 || read_usec < 0) {
+    printf("Incorrect usage!\n\t./prefetchbench (frames) (usec per cover read)\n");
+    return 1;
+  }
+
+  if (write_cover_dat(BENCH_FILE)) {
+    printf("ERR: unable to write %s\n", BENCH_FILE);
+    return 1;
+  }
+  DAT_init(&bin);
+  DAT_load_parse(&bin, BENCH_FILE);
+
+  void *vram = malloc(CACHE_SLOTS * CHUNK_SIZE);
+  sync_buf = malloc(CHUNK_SIZE);
+  pool_create(&pool, vram, CACHE_SLOTS * CHUNK_SIZE, CACHE_SLOTS);
+  cache_set_size(&cache, CACHE_SLOTS);
+  cache_callback_userdata(&cache, &pool);
+  cache_callback_add(&cache, pool_add_cb);
+  cache_callback_del(&cache, pool_del_cb);
+
+  run_result in_frame, prefetch;
+  run(frames, &in_frame);
+
+  prefetch_queue_create(&staging, CHUNK_SIZE, STAGING);
+  prefetch_start(slow_read);
+  run(frames, &prefetch);
+  prefetch_stop();
+  prefetch_queue_destroy(&staging);
+
+  printf("\n%d frames each, %ld usec per cover read\n", frames, read_usec);
+  printf("%-10s %10s %10s %10s %9s %9s\n", "loader", "mean us", "stddev us", "worst us", "overran", "missing");
+  print_result("in frame", &in_frame, frames);
+  print_result("prefetch", &prefetch, frames);
+
+  empty_cache(&cache);
+  pool_destroy(&pool);
+  free(vram);
+  free(sync_buf);
+  DAT_close(&bin);
+  remove(BENCH_FILE);
+  return wrong ? 1 : EXIT_SUCCESS;
+}
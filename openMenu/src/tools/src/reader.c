@@ -42,15 +42,23 @@ void DAT_dump(const dat_file *bin, const char *output) {
 
   DBG_PRINT("BIN Stats:\nChunk Size: %u\nNum Chunks: %u\n\n", bin->chunk_size, bin->num_chunks);
   for (int i = 0; i < bin->num_chunks; i++) {
-    DBG_PRINT("Record[%u] %s at 0x%X\n", bin->items[i].offset, bin->items[i].ID, bin->items[i].offset * bin->chunk_size);
+    const char *ID = DAT_VERSION_IS_PACKED(bin->version) ? bin->packed[i].ID : bin->index[i].ID;
+    /* Empty IDs are entries deleted by datpatch */
+    if (!ID[0]) {
+      continue;
+    }
+    DBG_PRINT("Record[%u] %s at 0x%X\n", i, ID, DAT_get_offset_by_ID(bin, ID));
     /* Create output filename */
     strcpy(out_filename, output);
-    strcat(out_filename, bin->items[i].ID);
+    strcat(out_filename, ID);
     strcat(out_filename, ".pvr");
 
-    /* Read chunk to buffer */
-    int ret_f = fseek((FILE *)bin->handle, bin->items[i].offset * bin->chunk_size, SEEK_SET);
-    int ret_r = fread(file_buffer, bin->chunk_size, 1, (FILE *)bin->handle);
+    /* Read chunk to buffer, ver3 chunks come back decompressed */
+    int ret_r = DAT_read_file_by_ID(bin, ID, file_buffer);
+    if (!ret_r) {
+      printf("ERR: unable to read %.12s, not written!\n", ID);
+      continue;
+    }
 
     /* Write out */
     FILE *fd = fopen(out_filename, "wb");
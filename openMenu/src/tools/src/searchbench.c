@@ -0,0 +1,203 @@
+/*
+ * File: searchbench.c
+ * Project: tools
+ * File Created: Friday, 16th October 2026 11:20:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include <backend/gd_item.h>
+#include <backend/gd_list.h>
+
+/* Called:
+./searchbench (games)
+
+Writes a synthetic OPENMENU.INI with 10000 games unless told otherwise, then
+types a set of queries into list_set_search one char at a time. Every result
+is checked against a plain scan, names starting with the query first then
+names containing it, in name order, however the query was typed. Two fixed
+names make the groups interleave once a keystroke refines the last result.
+The index is built by list_search_prepare first, as the search popup does,
+and timed apart from the keystrokes. Typing a query nothing matches must
+bring the last results back through list_search_restore.
+*/
+
+#define BENCH_FILE "searchbench.tmp"
+
+static const char *words[] = {
+    "Sonic",   "Adventure", "Crazy",   "Taxi",     "Soul",    "Calibur", "Shenmue", "Jet",    "Set",    "Radio",
+    "Power",   "Stone",     "Marvel",  "Capcom",   "Virtua",  "Tennis",  "Striker", "Rush",   "Street", "Fighter",
+    "Grandia", "Skies",     "Arcadia", "Resident", "Evil",    "Code",    "Veronica", "Ikaruga", "Space", "Channel",
+    "Metropolitan", "Racer", "Phantasy", "Star",   "Online",  "Hydro",   "Thunder", "Gun",    "Smash",  "Pack",
+    "Dead",    "Alive",     "House",   "Typing",   "Samba",   "Amigo",   "Chu",     "Rocket", "Bangai", "Zombie",
+};
+#define NUM_WORDS ((int)(sizeof(words) / sizeof(words[0])))
+
+static const char *queries[] = {"sonic adv", "soul", "rocket", "code ver", "zzz", "a", "metro", "2", "dead al", "xq", "qjxq"};
+#define NUM_QUERIES ((int)(sizeof(queries) / sizeof(queries[0])))
+
+static const gd_item **by_name;
+static const gd_item **expected;
+static int num_games;
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+static int write_synthetic_ini(const char *path, int games) {
+  FILE *fd = fopen(path, "wb");
+  if (!fd) {
+    return -1;
+  }
+  srand(2026);
+  fprintf(fd, "[OPENMENU]\nnum_items=%d\n\n[ITEMS]\n01.name=openMenu\n01.product=NEODC_1\n", games + 3);
+  for (int i = 2; i <= games + 1; i++) {
+    fprintf(fd, "%02d.name=", i);
+    const int num_words = 1 + rand() % 4;
+    for (int w = 0; w < num_words; w++) {
+      fprintf(fd, "%s%s", w ? " " : "", words[rand() % NUM_WORDS]);
+    }
+    if (rand() % 3 == 0) {
+      fprintf(fd, " %d", 1 + rand() % 4);
+    }
+    fprintf(fd, "\n%02d.product=T%05dN\n%02d.region=%s\n%02d.disc=1/1\n", i, i, i, (i % 3) ? "U" : "JUE", i);
+  }
+  /* Typing "qjxq" refines "qjx", the name that only contained it then sorts first */
+  fprintf(fd, "%02d.name=1 Qjxq\n%02d.product=T%05dN\n%02d.disc=1/1\n", games + 2, games + 2, games + 2, games + 2);
+  fprintf(fd, "%02d.name=Qjx Qjxq\n%02d.product=T%05dN\n%02d.disc=1/1\n", games + 3, games + 3, games + 3, games + 3);
+  fclose(fd);
+  return 0;
+}
+
+static int contains(const char *name, const char *query) {
+  const size_t len = strlen(query);
+  for (; *name; name++) {
+    if (!strncasecmp(name, query, len)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* The same answer the slow way */
+static int scan(const char *query) {
+  const size_t len = strlen(query);
+  int count = 0;
+  for (int i = 0; i < num_games; i++) {
+    if (!strncasecmp(by_name[i]->name, query, len)) {
+      expected[count++] = by_name[i];
+    }
+  }
+  for (int i = 0; i < num_games; i++) {
+    if (strncasecmp(by_name[i]->name, query, len) && contains(by_name[i]->name, query)) {
+      expected[count++] = by_name[i];
+    }
+  }
+  return count;
+}
+
+static int check(const char *query, int count) {
+  if (count != scan(query)) {
+    printf("ERR: \"%s\" found %d games, expected %d!\n", query, count, scan(query));
+    return -1;
+  }
+  for (int i = 0; i < count; i++) {
+    if (list_item_get(i) != expected[i]) {
+      printf("ERR: \"%s\" result %d is %s, expected %s!\n", query, i, list_item_get(i)->name, expected[i]->name);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int games = 10000;
+  if (argc > 1) {
+    games = atoi(argv[1]);
+  }
+  if (games <= 0) {
+    printf("Incorrect usage!\n\t./searchbench (games)\n");
+    return 1;
+  }
+  if (write_synthetic_ini(BENCH_FILE, games) || list_read(BENCH_FILE)) {
+    printf("ERR: unable to write %s\n", BENCH_FILE);
+    return 1;
+  }
+  remove(BENCH_FILE);
+
+  list_set_sort_alphabetical();
+  num_games = list_length();
+  by_name = malloc(num_games * sizeof(gd_item *));
+  expected = malloc(num_games * sizeof(gd_item *));
+  if (!by_name || !expected) {
+    printf("ERR: no free memory!\n");
+    return 1;
+  }
+  for (int i = 0; i < num_games; i++) {
+    by_name[i] = list_item_get(i);
+  }
+
+  double start = now_us();
+  list_search_prepare();
+  const double build = now_us() - start;
+
+  printf("\n%d games\n", num_games);
+  printf("%-12s %6s %12s %12s %10s\n", "query", "chars", "usec/char", "usec worst", "matches");
+
+  double worst = 0, total = 0, scan_total = 0;
+  int keystrokes = 0;
+  for (int q = 0; q < NUM_QUERIES; q++) {
+    char typed[64] = {0};
+    const int len = (int)strlen(queries[q]);
+    double query_total = 0, query_worst = 0;
+    int count = 0;
+    int last_count = 0;
+    /* Starting over, as the UI does when the search box is cleared */
+    list_set_search("");
+    for (int c = 0; c < len; c++) {
+      typed[c] = queries[q][c];
+      start = now_us();
+      count = list_set_search(typed);
+      const double elapsed = now_us() - start;
+      query_total += elapsed;
+      query_worst = elapsed > query_worst ? elapsed : query_worst;
+      keystrokes++;
+
+      const double scan_start = now_us();
+      scan(typed);
+      scan_total += now_us() - scan_start;
+      if (check(typed, count)) {
+        return 1;
+      }
+      /* A dropped key shows what the query before it matched */
+      if (!count && last_count) {
+        typed[c] = '\0';
+        if (list_search_restore(typed) != scan(typed) || check(typed, list_length())) {
+          printf("ERR: \"%s\" did not come back after a key matching nothing!\n", typed);
+          return 1;
+        }
+        typed[c] = queries[q][c];
+      }
+      last_count = count;
+    }
+    total += query_total;
+    worst = query_worst > worst ? query_worst : worst;
+    printf("%-12s %6d %12.1f %12.1f %10d\n", queries[q], len, query_total / len, query_worst, count);
+  }
+
+  printf("\nbuilding the index when search opens: %.1f usec\n", build);
+  printf("per keystroke: %.1f usec mean, %.1f usec worst\n", total / keystrokes, worst);
+  printf("plain scan per keystroke: %.1f usec\n", scan_total / keystrokes);
+
+  list_destroy();
+  free(by_name);
+  free(expected);
+  return EXIT_SUCCESS;
+}
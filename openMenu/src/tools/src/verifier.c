@@ -0,0 +1,244 @@
+/*
+ * File: verifier.c
+ * Project: tools
+ * File Created: Friday, 16th October 2026 6:05:00 pm
+ * -----
+ * License: BSD 3-clause "New" or "Revised" License, http://www.opensource.org/licenses/BSD-3-Clause
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <backend/dat_format.h>
+#include <texture/crc32c.h>
+#include <texture/lz4_block.h>
+
+/* Called:
+./datverify file.dat... (-j N)
+
+Checks every chunk of each DAT is inside the file and intact
+DAT4 chunks are checked against their CRC32C, DAT3 chunks without checksums
+must decompress to exactly chunk_size, DAT1 and DAT2 only get the size check
+-j N checks on N threads, each with its own handle on the file
+Returns 1 if anything is wrong
+*/
+
+#define NUM_ARGS     (1)
+#define VERIFY_BATCH (16) /* Chunks handed to a worker at once */
+
+/* One stored chunk, shared chunks are only checked once */
+typedef struct verify_job {
+  uint32_t offset;
+  uint32_t length;
+  uint32_t pos; /* First table entry pointing here */
+} verify_job;
+
+/* Locals */
+static dat_file bin;
+static const char *verify_path;
+static long verify_file_size;
+static verify_job *jobs;
+static uint32_t num_jobs;
+static uint32_t num_live;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t next_job;
+static uint32_t num_bad;
+static double bytes_checked;
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000.0) + (ts.tv_nsec / 1000.0);
+}
+
+static int compare_job(const void *a, const void *b) {
+  const uint32_t offset_a = ((const verify_job *)a)->offset;
+  const uint32_t offset_b = ((const verify_job *)b)->offset;
+  return (offset_a > offset_b) - (offset_a < offset_b);
+}
+
+static const char *entry_ID(uint32_t pos) {
+  return DAT_VERSION_IS_PACKED(bin.version) ? bin.packed[pos].ID : bin.index[pos].ID;
+}
+
+/* Unique chunks in file order, so every worker reads forwards */
+static int build_jobs(void) {
+  jobs = malloc((bin.num_chunks + 1) * sizeof(verify_job));
+  if (!jobs) {
+    printf("ERR: no free memory!\n");
+    return -1;
+  }
+  /* Entries deleted by datpatch keep an empty ID, their space is not live data */
+  num_live = 0;
+  for (uint32_t i = 0; i < bin.num_chunks; i++) {
+    if (!entry_ID(i)[0]) {
+      continue;
+    }
+    if (DAT_VERSION_IS_PACKED(bin.version)) {
+      jobs[num_live++] = (verify_job){bin.packed[i].offset, bin.packed[i].length, i};
+    } else {
+      jobs[num_live++] = (verify_job){bin.index[i].offset * bin.chunk_size, bin.chunk_size, i};
+    }
+  }
+  qsort(jobs, num_live, sizeof(verify_job), compare_job);
+
+  num_jobs = 0;
+  for (uint32_t i = 0; i < num_live; i++) {
+    if (num_jobs && jobs[num_jobs - 1].offset == jobs[i].offset && jobs[num_jobs - 1].length == jobs[i].length) {
+      /* Shared chunks must agree on their checksum too */
+      if (bin.crc && bin.crc[jobs[num_jobs - 1].pos] != bin.crc[jobs[i].pos]) {
+        printf("ERR: %.12s and %.12s share a chunk but not a checksum!\n", entry_ID(jobs[num_jobs - 1].pos),
+               entry_ID(jobs[i].pos));
+        num_bad++;
+      }
+      continue;
+    }
+    jobs[num_jobs++] = jobs[i];
+  }
+  return 0;
+}
+
+/* 0 if the chunk is good, prints why not otherwise */
+static int verify_chunk(FILE *fd, const verify_job *job, unsigned char *stored, unsigned char *decoded) {
+  const char *ID = entry_ID(job->pos);
+  if ((long)job->offset + (long)job->length > verify_file_size) {
+    printf("ERR: %.12s at 0x%X runs past the end of the file!\n", ID, job->offset);
+    return -1;
+  }
+  fseek(fd, job->offset, SEEK_SET);
+  if (fread(stored, job->length, 1, fd) != 1) {
+    printf("ERR: unable to read %.12s at 0x%X!\n", ID, job->offset);
+    return -1;
+  }
+  if (bin.crc) {
+    if (crc32c(0, stored, job->length) != bin.crc[job->pos]) {
+      printf("ERR: %.12s at 0x%X fails its checksum!\n", ID, job->offset);
+      return -1;
+    }
+    return 0;
+  }
+  if (DAT_VERSION_IS_PACKED(bin.version) && job->length < bin.chunk_size
+      && lz4_block_decompress(stored, (int)job->length, decoded, (int)bin.chunk_size) != (int)bin.chunk_size) {
+    printf("ERR: %.12s at 0x%X does not decompress!\n", ID, job->offset);
+    return -1;
+  }
+  return 0;
+}
+
+static void *verify_worker(void *arg) {
+  (void)arg;
+  uint32_t bad = 0;
+  double bytes = 0;
+  FILE *fd = fopen(verify_path, "rb");
+  unsigned char *stored = malloc(bin.chunk_size);
+  unsigned char *decoded = malloc(bin.chunk_size);
+  if (!fd || !stored || !decoded) {
+    /* The other workers still cover every chunk, this one just fails the run */
+    printf("ERR: worker unable to start on %s!\n", verify_path);
+    bad = 1;
+  } else {
+    for (;;) {
+      pthread_mutex_lock(&pool_lock);
+      const uint32_t first = next_job;
+      next_job = (next_job + VERIFY_BATCH < num_jobs) ? next_job + VERIFY_BATCH : num_jobs;
+      const uint32_t last = next_job;
+      pthread_mutex_unlock(&pool_lock);
+      if (first == last) {
+        break;
+      }
+
+      for (uint32_t i = first; i < last; i++) {
+        bad += (verify_chunk(fd, &jobs[i], stored, decoded) != 0);
+        bytes += jobs[i].length;
+      }
+    }
+  }
+
+  pthread_mutex_lock(&pool_lock);
+  num_bad += bad;
+  bytes_checked += bytes;
+  pthread_mutex_unlock(&pool_lock);
+  if (fd) {
+    fclose(fd);
+  }
+  free(stored);
+  free(decoded);
+  return NULL;
+}
+
+static int verify_file(const char *path, int num_threads) {
+  struct stat statbuf;
+  DAT_init(&bin);
+  if (stat(path, &statbuf) || DAT_load_parse(&bin, path)) {
+    printf("ERR: %s is not a readable DAT!\n", path);
+    return -1;
+  }
+  verify_path = path;
+  verify_file_size = (long)statbuf.st_size;
+  next_job = 0;
+  num_bad = 0;
+  bytes_checked = 0;
+
+  const double start = now_us();
+  if (build_jobs()) {
+    DAT_close(&bin);
+    return -1;
+  }
+
+  pthread_t *workers = malloc(sizeof(pthread_t) * num_threads);
+  if (!workers) {
+    printf("ERR: no free memory!\n");
+    DAT_close(&bin);
+    return -1;
+  }
+  for (int i = 0; i < num_threads; i++) {
+    pthread_create(&workers[i], NULL, verify_worker, NULL);
+  }
+  for (int i = 0; i < num_threads; i++) {
+    pthread_join(workers[i], NULL);
+  }
+  free(workers);
+  const double elapsed = now_us() - start;
+
+  const char *check = bin.crc ? "crc32c" : (DAT_VERSION_IS_PACKED(bin.version) ? "lz4 decode" : "size only");
+  printf("%s: DAT%u, %u entries, %u chunks, %s, %u bad, %.1f MB/s\n", path, bin.version, num_live, num_jobs,
+         check, num_bad, elapsed > 0 ? bytes_checked / elapsed : 0.0);
+
+  const int ret = num_bad ? -1 : 0;
+  free(jobs);
+  jobs = NULL;
+  DAT_close(&bin);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  int num_threads = 1;
+
+  if (argc < NUM_ARGS + 1 /*binary itself*/) {
+    printf("Incorrect usage!\n\t./datverify file.dat... (-j N)\n");
+    return 1;
+  }
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-j")) {
+      if (i + 1 >= argc || atoi(argv[i + 1]) <= 0) {
+        printf("Incorrect usage!\n\t./datverify file.dat... (-j N)\n");
+        return 1;
+      }
+      num_threads = atoi(argv[i + 1]);
+    }
+  }
+
+  int failed = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-j")) {
+      i++;
+      continue;
+    }
+    failed |= (verify_file(argv[i], num_threads) != 0);
+  }
+  return failed ? 1 : EXIT_SUCCESS;
+}